@@ -0,0 +1,175 @@
+// Host request generator for the HTTP stack
+// Runs the device's HttpClient (queue, pool, pipelining, parser, decoder,
+// cache) over PosixTransport and reports latency, throughput and errors.
+//
+//   http_fetch [-n requests] [-c connections] [-p pipeline] [-r retries]
+//              [-t timeout_ms] [-C] [-s] [-k] URL...
+//
+//   -n  requests in total, spread round-robin over the URLs (default 1)
+//   -c  connections open at once (default 2, as on the device)
+//   -p  requests pipelined per connection (default 2)
+//   -r  retries per request (default 0 - failures are counted, not hidden)
+//   -t  total timeout per request in ms (default 30000)
+//   -C  serve/revalidate through the response cache (default off)
+//   -s  send the URLs as given, so identical requests are coalesced
+//       (default: a distinct "_n=<i>" query per request, so each one is fetched)
+//   -k  accept any TLS certificate (local test servers)
+
+#include "http_client.h"
+#include "posix_transport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static uint32_t now_ms() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    uint32_t started_ms;
+    uint32_t latency_ms;
+    size_t bytes;
+    bool done;
+    bool success;
+    HttpError error;
+    int status_code;
+};
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-n requests] [-c connections] [-p pipeline] [-r retries] "
+                    "[-t timeout_ms] [-C] [-s] [-k] URL...\n", name);
+}
+
+int main(int argc, char** argv) {
+    size_t total = 1;
+    size_t max_connections = 2;
+    size_t max_pipeline = 2;
+    RequestOptions options;
+    options.max_retries = 0;
+    options.use_cache = false;
+    bool verify_peer = true;
+    bool distinct = true;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:p:r:t:Csk")) != -1) {
+        switch (opt) {
+            case 'n': total = (size_t)atoi(optarg); break;
+            case 'c': max_connections = (size_t)atoi(optarg); break;
+            case 'p': max_pipeline = (size_t)atoi(optarg); break;
+            case 'r': options.max_retries = (uint8_t)atoi(optarg); break;
+            case 't': options.total_timeout_ms = (uint32_t)atoi(optarg); break;
+            case 'C': options.use_cache = true; break;
+            case 's': distinct = false; break;
+            case 'k': verify_peer = false; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc || total == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::vector<std::string> urls(argv + optind, argv + argc);
+    
+    PosixTransport tcp;
+    PosixTlsTransport tls(verify_peer);
+    HttpClient client(max_connections, max_pipeline);
+    client.add_transport("http", &tcp);
+    client.add_transport("https", &tls);
+    
+    // Everything is queued up front; the client's own limits pace it
+    std::vector<Result> results(total);
+    size_t finished = 0;
+    uint32_t run_started = now_ms();
+    for (size_t i = 0; i < total; i++) {
+        Result& result = results[i];
+        result = { now_ms(), 0, 0, false, false, HttpError::NONE, 0 };
+        std::string url = urls[i % urls.size()];
+        if (distinct) {
+            url += (url.find('?') == std::string::npos ? "?_n=" : "&_n=") + std::to_string(i);
+        }
+        uint32_t id = client.get_stream(url,
+            [&result](std::string_view chunk) {
+                result.bytes += chunk.size();
+            },
+            [&result, &finished](bool success) {
+                result.latency_ms = now_ms() - result.started_ms;
+                result.success = success;
+                result.done = true;
+                finished++;
+            },
+            options,
+            [&result](HttpError error, int status_code) {
+                result.error = error;
+                result.status_code = status_code;
+            });
+        if (id == 0) {
+            result.done = true;
+            result.error = HttpError::INVALID_URL;
+            finished++;
+        }
+    }
+    
+    while (finished < total) {
+        client.process(now_ms());
+        PosixTransport::wait(5);
+    }
+    uint32_t run_ms = std::max<uint32_t>(now_ms() - run_started, 1);
+    
+    // Summary
+    std::vector<uint32_t> latencies;
+    std::map<std::string, size_t> failures;
+    size_t bytes = 0;
+    for (const Result& result : results) {
+        bytes += result.bytes;
+        if (result.success) {
+            latencies.push_back(result.latency_ms);
+        } else {
+            std::string reason = http_error_name(result.error);
+            if (result.error == HttpError::HTTP_STATUS) {
+                reason += " " + std::to_string(result.status_code);
+            }
+            failures[reason]++;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    
+    printf("\n%zu requests, %zu ok, %zu failed in %u ms (%.1f req/s, %.1f KB/s)\n", total, latencies.size(),
+           total - latencies.size(), (unsigned)run_ms, total * 1000.0 / run_ms, bytes / 1.024 / run_ms);
+    if (!latencies.empty()) {
+        uint64_t sum = 0;
+        for (uint32_t latency : latencies) {
+            sum += latency;
+        }
+        auto percentile = [&latencies](double p) {
+            return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+        };
+        printf("latency ms: min %u  avg %u  p50 %u  p90 %u  p99 %u  max %u\n", (unsigned)latencies.front(),
+               (unsigned)(sum / latencies.size()), (unsigned)percentile(0.50), (unsigned)percentile(0.90),
+               (unsigned)percentile(0.99), (unsigned)latencies.back());
+    }
+    for (const auto& failure : failures) {
+        printf("failed: %s x%zu\n", failure.first.c_str(), failure.second);
+    }
+    
+    const PosixTlsTransport::HandshakeStats& handshakes = tls.get_handshake_stats();
+    if (handshakes.count > 0) {
+        printf("TLS handshakes: %u (avg %u ms, min %u, max %u), %u resumed of %u offered\n",
+               (unsigned)handshakes.count, (unsigned)(handshakes.total_ms / handshakes.count),
+               (unsigned)handshakes.min_ms, (unsigned)handshakes.max_ms, (unsigned)handshakes.resumed,
+               (unsigned)handshakes.resumption_offered);
+    }
+    
+    const HttpCache::Stats& cache = client.get_queue().get_cache().get_stats();
+    if (options.use_cache) {
+        printf("cache: %u fresh hits, %u revalidated, %u stored\n", (unsigned)cache.fresh_hits,
+               (unsigned)cache.revalidated, (unsigned)cache.stored);
+    }
+    
+    return failures.empty() ? 0 : 1;
+}
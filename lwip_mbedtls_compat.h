@@ -27,6 +27,17 @@ int mbedtls_pk_parse_key(mbedtls_pk_context *pk,
 #define MBEDTLS_PK_PARSE_KEY_DECLARED
 #endif
 
+// The mbedTLS config behind an altcp TLS config
+// Shared by every connection made from it - only change it before the first one.
+// struct altcp_tls_config is private to lwIP's altcp_tls_mbedtls.c, but every
+// lwIP release (2.1, 2.2 as shipped in the Pico SDK) declares the
+// mbedtls_ssl_config as its first member, so the config pointer is also a
+// pointer to it.
+struct altcp_tls_config;
+static inline mbedtls_ssl_config* altcp_tls_config_get_ssl_config(struct altcp_tls_config *conf) {
+    return (mbedtls_ssl_config*)conf;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
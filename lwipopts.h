@@ -73,10 +73,14 @@
 #define LWIP_ALTCP_TLS              1
 #define LWIP_ALTCP_TLS_MBEDTLS      1
 
-// Disable session caching to avoid compatibility issues
+// Server-side session cache/tickets - not needed, we are only a client.
+// Client resumption is handled by TlsSessionCache (src/utils/tls_session_cache)
 #define ALTCP_MBEDTLS_USE_SESSION_CACHE 0
 #define ALTCP_MBEDTLS_USE_SESSION_TICKETS 0
 
+// Keep altcp from pointing mbedTLS at the shared heap - TLS has its own arena
+#define ALTCP_MBEDTLS_PLATFORM_ALLOC 0
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
 #define LWIP_STATS                  1
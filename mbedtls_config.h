@@ -6,8 +6,7 @@
 
 // System support
 #define MBEDTLS_PLATFORM_C
-#define MBEDTLS_PLATFORM_MEMORY
-#define MBEDTLS_MEMORY_BUFFER_ALLOC_C
+#define MBEDTLS_PLATFORM_MEMORY  // Allocations go to a dedicated arena (src/utils/tls_memory)
 #define MBEDTLS_PLATFORM_NO_STD_FUNCTIONS
 
 // SSL/TLS Core
@@ -17,6 +16,9 @@
 // Session Management - Minimal implementation
 #define MBEDTLS_SSL_SESSION_C
 
+// Client-side session tickets (RFC 5077) for abbreviated handshakes
+#define MBEDTLS_SSL_SESSION_TICKETS
+
 // Cryptographic algorithms
 #define MBEDTLS_AES_C
 #define MBEDTLS_CIPHER_MODE_CBC
@@ -43,11 +45,50 @@
 #define MBEDTLS_OID_C
 #define MBEDTLS_BASE64_C
 
-// Key exchange
+// Key exchange profile - select with -DTLS_PROFILE (CMake option TLS_PROFILE)
+//   TLS_PROFILE_RSA:   RSA key transport only. Smallest code, no forward
+//                      secrecy, and the server's RSA private-key operation
+//                      dominates the handshake. Kept for old hosts.
+//   TLS_PROFILE_ECDHE: ECDHE over X25519/P-256 with RSA or ECDSA server
+//                      certificates, RSA key transport as the last resort.
+#define TLS_PROFILE_RSA 1
+#define TLS_PROFILE_ECDHE 2
+
+#ifndef TLS_PROFILE
+#define TLS_PROFILE TLS_PROFILE_ECDHE
+#endif
+
 #define MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
 #define MBEDTLS_PKCS1_V15
 #define MBEDTLS_PKCS1_V21
 
+#if TLS_PROFILE == TLS_PROFILE_ECDHE
+// Elliptic curves - X25519 is offered first, P-256 for hosts without it
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_DP_CURVE25519_ENABLED
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+
+// A 4-point window trades ~1.5KB of heap during the handshake for speed
+#define MBEDTLS_ECP_WINDOW_SIZE 4
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM 1
+
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED
+
+// Offered in this order: forward-secret AEAD suites first, RSA transport last
+#define MBEDTLS_SSL_CIPHERSUITES \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256, \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256, \
+    MBEDTLS_TLS_RSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA256, \
+    MBEDTLS_TLS_RSA_WITH_AES_128_CBC_SHA
+#endif
+
 // Random number generation
 #define MBEDTLS_ENTROPY_C
 #define MBEDTLS_CTR_DRBG_C
@@ -65,10 +106,18 @@
 #define MBEDTLS_ERROR_C
 
 // Disable problematic features
-#define MBEDTLS_SSL_SESSION_TICKETS 0
 #define MBEDTLS_USE_PSA_CRYPTO 0
 
 // Memory settings
-#define MBEDTLS_SSL_MAX_CONTENT_LEN 4096
+// mbedTLS 3.x sizes the record buffers from IN/OUT_CONTENT_LEN. Incoming
+// records can be 16KB from servers that ignore max_fragment_length; our
+// requests are a few hundred bytes, so the output buffer can be small.
+#define MBEDTLS_SSL_IN_CONTENT_LEN 16384
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 2048
+
+// Ask for 4KB records, and shrink the buffers after the handshake to what
+// was negotiated (16KB -> 4KB per connection when the server agrees)
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
 
 #endif /* MBEDTLS_USER_CONFIG_FILE */
\ No newline at end of file
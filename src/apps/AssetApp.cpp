@@ -0,0 +1,248 @@
+#include "AssetApp.hpp"
+#include "../utils/text_renderer.h"
+#include <cstdio>
+
+AssetApp::AssetApp(DataSlot<AssetSnapshot>& slot, uint8_t ticker_r, uint8_t ticker_g, uint8_t ticker_b)
+    : slot(slot)
+    , ticker_r(ticker_r)
+    , ticker_g(ticker_g)
+    , ticker_b(ticker_b)
+    , drawn_version(0)
+    , horizontal(false)
+    , last_sample_ms(0)
+    , name_marquee(3, 11, 12)
+    , price_chart(5, 16, 54, 16, ChartStyle::AREA) {
+    name_marquee.set_color(100, 100, 100);
+    for (int i = 0; i < 5; i++) {
+        list_charts.emplace_back(19, ASSET_LIST_TOP + (i * ASSET_LIST_ROW_PITCH), 12, 5, ChartStyle::LINE, RotationMode::VERTICAL_CLOCKWISE);
+    }
+}
+
+void AssetApp::publish_assets() {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t now_s = now_ms / 1000;
+    last_sample_ms = now_ms;
+    ingest.history.resize(ingest.assets.size());
+    rollups.resize(ingest.assets.size());
+    for (size_t i = 0; i < ingest.assets.size(); i++) {
+        float price = parse_price(ingest.assets[i].price);
+        ingest.history[i].push(price);
+        rollups[i].add(price, now_s);
+    }
+    build_charts();
+    slot.publish(ingest);
+}
+
+void AssetApp::build_charts() {
+    bool rolled = ingest.timeframe != Timeframe::TICKS;
+    ingest.charts.resize(rolled ? rollups.size() : 0);
+    for (size_t i = 0; i < ingest.charts.size(); i++) {
+        TimeframeChart& chart = ingest.charts[i];
+        chart.wide_count = rollups[i].downsample(ingest.timeframe, chart.wide, CHART_WIDE_POINTS);
+        chart.narrow_count = rollups[i].downsample(ingest.timeframe, chart.narrow, CHART_LIST_POINTS);
+    }
+}
+
+bool AssetApp::has_chart(const AssetSnapshot& snapshot, int index) const {
+    if (snapshot.timeframe == Timeframe::TICKS) {
+        return index < (int)snapshot.history.size() && snapshot.history[index].size() >= 2;
+    }
+    return index < (int)snapshot.charts.size() && snapshot.charts[index].wide_count >= 2;
+}
+
+uint32_t AssetApp::data_version() const {
+    return slot.latest_version();
+}
+
+bool AssetApp::needs_redraw() const {
+    return BaseApp::needs_redraw() || slot.latest_version() != drawn_version;
+}
+
+void AssetApp::draw(RenderContext& ctx, bool is_horizontal) {
+    const AssetSnapshot& snapshot = slot.read();
+    drawn_version = slot.read_version();
+    if (snapshot.assets.empty()) {
+        return;
+    }
+    
+    if (is_horizontal) {
+        // Horizontal: Single asset with large logo and details (stockTicker style)
+        int asset_idx = sub_state % snapshot.assets.size();
+        draw_single_asset(ctx, is_horizontal, snapshot, asset_idx);
+    } else {
+        // Vertical: Static list of all assets
+        draw_asset_list(ctx, is_horizontal, snapshot);
+    }
+}
+
+void AssetApp::draw_background(RenderContext& ctx, bool is_horizontal) {
+    if (!is_horizontal) {
+        return;
+    }
+    
+    // Graph baseline, same geometry as draw_graph_24h_change
+    bool rotate = true;
+    int graph_center_y = 23;
+    int graph_start_x = 5;
+    int graph_width = 54;
+    for (int x = graph_start_x; x < graph_start_x + graph_width; x++) {
+        draw_pixel(ctx, x, graph_center_y, 100, 100, 100, rotate);
+    }
+}
+
+void AssetApp::on_enter() {
+    BaseApp::on_enter();
+    name_marquee.reset();
+}
+
+void AssetApp::service(uint32_t now_ms) {
+    // New price samples; the store version change brings the redraw
+    if (now_ms - last_sample_ms >= ASSET_SAMPLE_INTERVAL_MS) {
+        publish_assets();
+    }
+}
+
+void AssetApp::update(uint32_t dt_ms) {
+    // The vertical list has no marquee - nothing to move or redraw
+    if (horizontal && name_marquee.update(dt_ms)) {
+        invalidate();
+    }
+}
+
+void AssetApp::draw_animated(RenderContext& ctx, bool is_horizontal) {
+    const std::vector<AssetData>& assets = slot.read().assets;
+    if (!is_horizontal || assets.empty()) {
+        return;
+    }
+    
+    // Rasterised again only when the asset changes
+    name_marquee.set_text(assets[sub_state % assets.size()].name);
+    name_marquee.draw(ctx);
+}
+
+void AssetApp::draw_single_asset(RenderContext& ctx, bool is_horizontal, const AssetSnapshot& snapshot, int index) {
+    const AssetData& asset = snapshot.assets[index];
+    bool rotate = true; // Always rotate 180° for proper orientation
+    
+    // Top half: Asset symbol and price
+    draw_string(ctx, 3, 3, asset.ticker, ticker_r, ticker_g, ticker_b, rotate);  // Asset symbol
+    draw_string(ctx, 25, 3, format_price(asset.price, false), 255, 255, 0, rotate); // Price (yellow)
+    
+    // Bottom half: price history once there is some, else the 24h change bar
+    if (has_chart(snapshot, index)) {
+        draw_price_chart(ctx, asset.change_24h, snapshot, index, rotate);
+    } else {
+        draw_graph_24h_change(ctx, asset.change_24h, rotate);
+    }
+}
+
+void AssetApp::draw_asset_list(RenderContext& ctx, bool is_horizontal, const AssetSnapshot& snapshot) {
+    const std::vector<AssetData>& assets = snapshot.assets;
+    
+    // Chart timeframe the button cycles through (grey, like the name marquee)
+    draw_text_bitmap_mode(ctx, 2, ASSET_LIST_LABEL_Y, get_timeframe_name(snapshot.timeframe), 100, 100, 100,
+                          RotationMode::VERTICAL_CLOCKWISE);
+    
+    // Vertical layout (32x64) - Asset list view matching WeatherApp pattern
+    for (int i = 0; i < 5 && i < assets.size(); i++) {
+        const AssetData& asset = assets[i];
+        int y_symbol = ASSET_LIST_TOP + (i * ASSET_LIST_ROW_PITCH);    // Symbol position
+        int y_price = y_symbol + 6;     // Price position (reduced gap)
+        
+        // Draw asset symbol in white using vertical rotation
+        draw_text_white_mode(ctx, 2, y_symbol, asset.ticker, RotationMode::VERTICAL_CLOCKWISE);
+        
+        // Draw current price in white using vertical rotation
+        draw_text_white_mode(ctx, 13, y_price, format_price(asset.price, true), RotationMode::VERTICAL_CLOCKWISE);
+        
+        // Draw 24h change with color coding using vertical rotation
+        std::string change_str = (asset.change_24h >= 0 ? "+" : "") + std::to_string(asset.change_24h).substr(0, 4) + "%";
+        if (asset.change_24h >= 0) {
+            draw_text_red_mode(ctx, 23, y_price, change_str, RotationMode::VERTICAL_CLOCKWISE);  // Green for positive
+        } else {
+            draw_text_blue_mode(ctx, 23, y_price, change_str, RotationMode::VERTICAL_CLOCKWISE); // Red for negative
+        }
+        
+        // Price history sparkline beside the symbol
+        if (has_chart(snapshot, i)) {
+            Sparkline& chart = list_charts[i];
+            chart.set_color(asset.change_24h >= 0 ? 0 : 255, asset.change_24h >= 0 ? 255 : 0, 0);
+            if (snapshot.timeframe == Timeframe::TICKS) {
+                chart.update(snapshot.history[i], i);
+            } else {
+                chart.update(snapshot.charts[i].narrow, snapshot.charts[i].narrow_count, i, drawn_version);
+            }
+            chart.draw(ctx);
+        }
+    }
+}
+
+void AssetApp::draw_price_chart(RenderContext& ctx, float change_percent, const AssetSnapshot& snapshot, int index, bool rotate) {
+    // Same colours as the 24h bar; raw samples are laid out only as they arrive
+    uint8_t chart_r = change_percent >= 0 ? 0 : 255;
+    uint8_t chart_g = change_percent >= 0 ? 255 : 0;
+    price_chart.set_color(chart_r, chart_g, 0);
+    if (snapshot.timeframe == Timeframe::TICKS) {
+        price_chart.update(snapshot.history[index], index);
+    } else {
+        const TimeframeChart& chart = snapshot.charts[index];
+        price_chart.update(chart.wide, chart.wide_count, index, drawn_version);
+    }
+    price_chart.draw(ctx);
+    
+    std::string change_str = (change_percent >= 0 ? "+" : "") + std::to_string(change_percent).substr(0, 4) + "%";
+    draw_string(ctx, 25, 10, change_str, chart_r, chart_g, 0, rotate);
+}
+
+void AssetApp::draw_graph_24h_change(RenderContext& ctx, float change_percent, bool rotate) {
+    // Simple bar graph in bottom half (y 16-30)
+    int graph_center_y = 23;  // Middle of bottom half
+    int graph_start_x = 5;
+    int graph_width = 54;     // Most of the width
+    
+    // Normalize change to graph height (max ±8 pixels from center)
+    int max_change = 10;  // Assume max ±10% change for scaling
+    int bar_height = (int)((change_percent / max_change) * 8);
+    bar_height = std::max(-8, std::min(8, bar_height)); // Clamp to ±8 pixels
+    
+    // Choose color based on positive/negative
+    uint8_t bar_r = change_percent >= 0 ? 0 : 255;
+    uint8_t bar_g = change_percent >= 0 ? 255 : 0;
+    uint8_t bar_b = 0;
+    
+    // Draw the change bar (over the baseline from the background layer)
+    if (bar_height > 0) {
+        // Positive change - bar goes up
+        for (int y = graph_center_y - bar_height; y <= graph_center_y; y++) {
+            for (int x = graph_start_x + 10; x < graph_start_x + graph_width - 10; x++) {
+                draw_pixel(ctx, x, y, bar_r, bar_g, bar_b, rotate);
+            }
+        }
+    } else if (bar_height < 0) {
+        // Negative change - bar goes down
+        for (int y = graph_center_y; y <= graph_center_y - bar_height; y++) {
+            for (int x = graph_start_x + 10; x < graph_start_x + graph_width - 10; x++) {
+                draw_pixel(ctx, x, y, bar_r, bar_g, bar_b, rotate);
+            }
+        }
+    }
+    
+    // Draw change percentage text
+    std::string change_str = (change_percent >= 0 ? "+" : "") + std::to_string(change_percent).substr(0, 4) + "%";
+    draw_string(ctx, 25, 10, change_str, bar_r, bar_g, bar_b, rotate);
+}
+
+void AssetApp::handle_button_press(bool is_horizontal) {
+    // Horizontal: cycle assets
+    if (is_horizontal) {
+        size_t count = slot.read().assets.size();
+        sub_state = count ? (sub_state + 1) % count : 0;
+        return;
+    }
+    
+    // Vertical: next chart timeframe - the rollups already hold it, no fetch
+    ingest.timeframe = (Timeframe)(((int)ingest.timeframe + 1) % (int)Timeframe::COUNT);
+    build_charts();
+    slot.publish(ingest);
+    printf("%s: Chart timeframe %s\n", get_name(), get_timeframe_name(ingest.timeframe));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../core/BaseApp.hpp"
+#include "../core/DataStore.hpp"
+#include "../utils/marquee.h"
+#include "../utils/sparkline.h"
+
+// How often the asset prices are sampled into their history and rollups
+#define ASSET_SAMPLE_INTERVAL_MS 15000
+
+// Vertical list: the chart timeframe label sits above the rows (symbol
+// line, then price line), which are packed tight to leave it room
+#define ASSET_LIST_LABEL_Y 1
+#define ASSET_LIST_TOP 7
+#define ASSET_LIST_ROW_PITCH 11
+
+// Shared screens of the price apps (stocks, crypto)
+// Horizontal: one asset with its name marquee and price chart; the button
+// cycles assets. Vertical: the list of assets with sparklines; the button
+// cycles the chart timeframe. Subclasses fill ingest.assets, then call
+// publish_assets(); from then on service() samples the prices on a timer,
+// on or off screen, so the history and rollups stay evenly spaced.
+class AssetApp : public BaseApp {
+public:
+    AssetApp(DataSlot<AssetSnapshot>& slot, uint8_t ticker_r, uint8_t ticker_g, uint8_t ticker_b);
+    virtual ~AssetApp() = default;
+    
+    void draw(RenderContext& ctx, bool is_horizontal) override;
+    bool has_background(bool is_horizontal) const override { return is_horizontal; }
+    void draw_background(RenderContext& ctx, bool is_horizontal) override;
+    bool is_animated(bool is_horizontal) const override { return is_horizontal; }
+    void draw_animated(RenderContext& ctx, bool is_horizontal) override;
+    void on_enter() override;
+    void on_orientation(bool is_horizontal) override { horizontal = is_horizontal; }
+    void service(uint32_t now_ms) override;
+    void update(uint32_t dt_ms) override;
+    void handle_button_press(bool is_horizontal) override;
+    bool needs_redraw() const override;
+    uint32_t data_version() const override;
+    
+protected:
+    AssetSnapshot ingest;        // Writer side: latest assets and their price history
+    
+    // Sample every asset's price into its history and publish the lot
+    void publish_assets();
+    
+    // Price as drawn; in_list is the narrower vertical list
+    virtual std::string format_price(const std::string& price, bool in_list) const {
+        (void)in_list;
+        return "$" + price;
+    }
+    
+private:
+    DataSlot<AssetSnapshot>& slot;
+    uint8_t ticker_r, ticker_g, ticker_b;
+    uint32_t drawn_version;      // Store version on screen
+    bool horizontal;             // Orientation on screen; the marquee only shows in horizontal
+    uint32_t last_sample_ms;     // When publish_assets() last ran
+    Marquee name_marquee;        // Full asset name, left of the graph bar
+    std::vector<OhlcRollup> rollups;     // Writer side: bars at every resolution, same order as assets
+    Sparkline price_chart;       // Horizontal view, in place of the 24h bar
+    std::vector<Sparkline> list_charts;  // Vertical list, one per row
+    
+    // Downsample every asset's rollup at ingest.timeframe into ingest.charts
+    void build_charts();
+    // Enough points to chart asset index at the snapshot's timeframe
+    bool has_chart(const AssetSnapshot& snapshot, int index) const;
+    
+    void draw_single_asset(RenderContext& ctx, bool is_horizontal, const AssetSnapshot& snapshot, int index);
+    void draw_asset_list(RenderContext& ctx, bool is_horizontal, const AssetSnapshot& snapshot);
+    void draw_graph_24h_change(RenderContext& ctx, float change_percent, bool rotate);
+    void draw_price_chart(RenderContext& ctx, float change_percent, const AssetSnapshot& snapshot, int index, bool rotate);
+};
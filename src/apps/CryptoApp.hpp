@@ -1,20 +1,14 @@
 #pragma once
 
-#include "../core/BaseApp.hpp"
+#include "AssetApp.hpp"
 
-class CryptoApp : public BaseApp {
+class CryptoApp : public AssetApp {
 public:
     CryptoApp();
     ~CryptoApp() = default;
     
-    void draw(bool is_horizontal) override;
-    void handle_button_press(bool is_horizontal) override;
+    const char* get_name() const override { return "Crypto"; }
     
 private:
-    std::vector<AssetData> crypto_assets;
-    
-    void draw_single_asset(bool is_horizontal, const AssetData& asset);
-    void draw_asset_list(bool is_horizontal);
     void initialize_crypto_data();
-    void draw_graph_24h_change(float change_percent, bool rotate);
 };
\ No newline at end of file
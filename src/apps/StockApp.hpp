@@ -1,20 +1,18 @@
 #pragma once
 
-#include "../core/BaseApp.hpp"
+#include "AssetApp.hpp"
 
-class StockApp : public BaseApp {
+class StockApp : public AssetApp {
 public:
     StockApp();
     ~StockApp() = default;
     
-    void draw(bool is_horizontal) override;
-    void handle_button_press(bool is_horizontal) override;
+    const char* get_name() const override { return "Stocks"; }
     
-private:
-    std::vector<AssetData> stock_assets;
+protected:
+    // Share prices are cut to the room they have
+    std::string format_price(const std::string& price, bool in_list) const override;
     
-    void draw_single_asset(bool is_horizontal, const AssetData& asset);
-    void draw_asset_list(bool is_horizontal);
+private:
     void initialize_stock_data();
-    void draw_graph_24h_change(float change_percent, bool rotate);
 };
\ No newline at end of file
@@ -1,26 +1,68 @@
 #include "WeatherApp.hpp"
 #include "../utils/text_renderer.h"
 #include "../utils/https_client.h"
+#include "../utils/network_manager.h"
 #include <sstream>
 #include <iomanip>
 
-WeatherApp::WeatherApp() : https_client(nullptr), api_data_loaded(false) {
+// Weather API host, resolved ahead of the playlist slot
+#define WEATHER_API_HOST "api.openweathermap.org"
+
+WeatherApp::WeatherApp()
+    : drawn_version(0)
+    , https_client(nullptr)
+    , network(nullptr)
+    , network_listener(0)
+    , api_data_loaded(false)
+    , fetch_in_flight(false)
+    , weather_parser([this](const std::string& path, const std::string& value) {
+          handle_weather_value(path, value);
+      })
+    , pending_sunrise(0)
+    , pending_sunset(0)
+    , pending_tz_offset(0) {
     initialize_mock_data();
     load_weather_icons();
+}
+
+void WeatherApp::attach_network(NetworkManager& network) {
+    this->network = &network;
+    https_client = new HttpsClient(network);
     
-    // Initialize HTTPS client
-    https_client = new HttpsClient();
-    if (https_client && https_client->init("EddyBsHouse", "swiftwater496")) {
-        printf("WeatherApp: HTTPS client initialized successfully\n");
+    // Fetch as soon as WiFi comes up, until the first response has landed.
+    // This runs from the network poll whichever app is on screen.
+    network_listener = network.add_state_listener([this](NetworkState state) {
+        if (state == NetworkState::CONNECTED && !api_data_loaded) {
+            fetch_weather_data();
+        }
+    });
+    if (!api_data_loaded && https_client->is_connected()) {
+        fetch_weather_data();
+    }
+}
+
+void WeatherApp::prefetch() {
+    // Have the API host's address ready (refreshed only when close to expiry)
+    if (network && network->is_connected()) {
+        network->get_dns_cache().prefetch(WEATHER_API_HOST);
+    }
+    
+    // Fresh cached responses are answered without touching the network
+    if (https_client && https_client->is_connected() && !fetch_in_flight) {
         fetch_weather_data();
-    } else {
-        printf("WeatherApp: Failed to initialize HTTPS client\n");
+    }
+}
+
+void WeatherApp::on_exit() {
+    // Give the TLS buffers back while another app is on screen
+    if (https_client) {
+        https_client->close_idle_connections();
     }
 }
 
 void WeatherApp::initialize_mock_data() {
     // Initial data for NYC - will be replaced by API calls
-    current_weather = {
+    ingest.current = {
         "New York",     // location
         72,             // current_temp
         65,             // min_temp
@@ -35,13 +77,14 @@ void WeatherApp::initialize_mock_data() {
     };
     
     // Mock forecast data - 5 days for weekly view
-    forecast_data = {
+    ingest.forecast = {
         {"NYC", 75, 68, 82, 55, 10, "02d", "6:46", "7:31", "Partly cloudy", "MON"},
         {"NYC", 73, 66, 80, 65, 25, "10d", "6:47", "7:30", "Light rain", "TUE"},
         {"NYC", 71, 64, 77, 70, 40, "04d", "6:48", "7:29", "Cloudy", "WED"},
         {"NYC", 69, 62, 75, 45, 5, "01d", "6:49", "7:28", "Clear", "THU"},
         {"NYC", 74, 67, 81, 50, 15, "03d", "6:50", "7:27", "Scattered clouds", "FRI"}
     };
+    data_store.weather.publish(ingest);
 }
 
 void WeatherApp::load_weather_icons() {
@@ -50,11 +93,35 @@ void WeatherApp::load_weather_icons() {
     // This will require adding PNG decoding capabilities
 }
 
-void WeatherApp::draw(bool is_horizontal) {
-    // Process HTTPS client network events
-    if (https_client) {
-        https_client->process();
+uint32_t WeatherApp::data_version() const {
+    return data_store.weather.latest_version();
+}
+
+bool WeatherApp::needs_redraw() const {
+    return BaseApp::needs_redraw() || data_store.weather.latest_version() != drawn_version;
+}
+
+bool WeatherApp::has_background(bool is_horizontal) const {
+    return is_horizontal;
+}
+
+void WeatherApp::draw_background(RenderContext& ctx, bool is_horizontal) {
+    bool rotate = true;
+    
+    // Row labels of the horizontal layout
+    if (is_horizontal) {
+        draw_text_white(ctx, 3, 10, "RAIN", rotate);
+        draw_text_white(ctx, 3, 17, "RISE", rotate);
+        draw_text_white(ctx, 3, 24, "HUMIDITY", rotate);
     }
+}
+
+void WeatherApp::draw(RenderContext& ctx, bool is_horizontal) {
+    // Consistent snapshot, even while ingest publishes a newer one
+    const WeatherSnapshot& weather = data_store.weather.read();
+    drawn_version = data_store.weather.read_version();
+    const WeatherData& current_weather = weather.current;
+    const std::vector<WeatherData>& forecast_data = weather.forecast;
     
     bool rotate = true; // Always rotate 180° for proper orientation
     
@@ -63,24 +130,23 @@ void WeatherApp::draw(bool is_horizontal) {
         // These coordinates match the working Python implementation
         
         // Temperature row: (3,3), (13,3), (23,3) - Python coordinates  
-        draw_text_blue(3, 3, std::to_string(current_weather.min_temp), rotate);   // Low temp
-        draw_text_white(13, 3, std::to_string(current_weather.current_temp), rotate); // Current temp
-        draw_text_red(23, 3, std::to_string(current_weather.max_temp), rotate);   // High temp
+        draw_text_blue(ctx, 3, 3, std::to_string(current_weather.min_temp), rotate);   // Low temp
+        draw_text_white(ctx, 13, 3, std::to_string(current_weather.current_temp), rotate); // Current temp
+        draw_text_red(ctx, 23, 3, std::to_string(current_weather.max_temp), rotate);   // High temp
+        
+        // Row labels (RAIN, RISE, HUMIDITY) come from the background layer
         
         // Rain row: (3,10), (21,10) - Python coordinates
-        draw_text_white(3, 10, "RAIN", rotate);
-        draw_text_white(21, 10, std::to_string(current_weather.rain_chance) + "%", rotate);
+        draw_text_white(ctx, 21, 10, std::to_string(current_weather.rain_chance) + "%", rotate);
         
         // Sunrise/sunset row: (3,17), (21,17) - Python coordinates  
-        draw_text_white(3, 17, "RISE", rotate);
-        draw_text_white(21, 17, current_weather.sunrise, rotate);
+        draw_text_white(ctx, 21, 17, current_weather.sunrise, rotate);
         
         // Humidity row: (3,24), (37,24) - Python coordinates
-        draw_text_white(3, 24, "HUMIDITY", rotate);
-        draw_text_white(37, 24, std::to_string(current_weather.humidity) + "%", rotate);
+        draw_text_white(ctx, 37, 24, std::to_string(current_weather.humidity) + "%", rotate);
         
         // Weather icon: (42,1) - 2px up, 2px left from previous position
-        ::draw_weather_icon(42, 1, current_weather.icon_code, rotate);
+        ::draw_weather_icon(ctx, 42, 1, current_weather.icon_code, rotate);
         
     } else {
         // Vertical layout (32x64) - Weekly forecast view
@@ -89,19 +155,23 @@ void WeatherApp::draw(bool is_horizontal) {
             int y_temp = y_day + 6;      // Temperature position (reduced gap from 8 to 6)
             
             // Draw day name in white using vertical rotation (moved 1 pixel right)
-            draw_text_white_mode(2, y_day, forecast_data[i].day_name, RotationMode::VERTICAL_CLOCKWISE);
+            draw_text_white_mode(ctx, 2, y_day, forecast_data[i].day_name, RotationMode::VERTICAL_CLOCKWISE);
             
             // Draw low temperature in blue using vertical rotation (moved slightly right)
-            draw_text_blue_mode(13, y_temp, std::to_string(forecast_data[i].min_temp), RotationMode::VERTICAL_CLOCKWISE);
+            draw_text_blue_mode(ctx, 13, y_temp, std::to_string(forecast_data[i].min_temp), RotationMode::VERTICAL_CLOCKWISE);
             
             // Draw high temperature in red using vertical rotation (moved slightly right)
-            draw_text_red_mode(23, y_temp, std::to_string(forecast_data[i].max_temp), RotationMode::VERTICAL_CLOCKWISE);
+            draw_text_red_mode(ctx, 23, y_temp, std::to_string(forecast_data[i].max_temp), RotationMode::VERTICAL_CLOCKWISE);
         }
     }
 }
 
 
 WeatherApp::~WeatherApp() {
+    if (network) {
+        network->remove_state_listener(network_listener);
+        network = nullptr;
+    }
     if (https_client) {
         delete https_client;
         https_client = nullptr;
@@ -113,28 +183,96 @@ void WeatherApp::fetch_weather_data() {
         printf("WeatherApp: HTTPS client not ready for request\n");
         return;
     }
+    if (fetch_in_flight) {
+        return;  // The parser is busy with the previous response
+    }
     
     // Use OpenWeatherMap API (requires API key)
     // For demo purposes, using a free weather API that supports HTTPS
-    std::string url = "https://api.openweathermap.org/data/2.5/weather?q=New York,NY&appid=YOUR_API_KEY&units=imperial";
+    std::string url = "https://" WEATHER_API_HOST "/data/2.5/weather?q=New York,NY&appid=YOUR_API_KEY&units=imperial";
     
     printf("WeatherApp: Requesting weather data...\n");
-    https_client->get(url, [this](const std::string& response) {
-        printf("WeatherApp: Received weather response: %s\n", response.c_str());
-        parse_weather_response(response);
-        api_data_loaded = true;
-    });
+    
+    // Parse the body as it streams in instead of buffering the whole response
+    weather_parser.reset();
+    pending_weather = ingest.current;
+    pending_sunrise = 0;
+    pending_sunset = 0;
+    pending_tz_offset = 0;
+    
+    fetch_in_flight = true;
+    uint32_t request_id = https_client->get_stream(url,
+        [this](std::string_view chunk) {
+            weather_parser.feed(chunk);
+        },
+        [this](bool success) {
+            finish_weather_response(success);
+        },
+        RequestOptions(),
+        [](HttpError error, int status_code) {
+            printf("WeatherApp: Weather request failed: %s (status %d)\n", http_error_name(error), status_code);
+        });
+    if (request_id == 0) {
+        fetch_in_flight = false;
+    }
 }
 
-void WeatherApp::parse_weather_response(const std::string& json_response) {
-    // Simple JSON parsing - in a real implementation, use a JSON library
-    // For now, just update with demo data to show HTTPS is working
-    printf("WeatherApp: Parsing weather response (basic implementation)\n");
+void WeatherApp::handle_weather_value(const std::string& path, const std::string& value) {
+    // OpenWeatherMap current weather fields
+    if (path == "main.temp") {
+        pending_weather.current_temp = (int)JsonStreamParser::to_number(value);
+    } else if (path == "main.temp_min") {
+        pending_weather.min_temp = (int)JsonStreamParser::to_number(value);
+    } else if (path == "main.temp_max") {
+        pending_weather.max_temp = (int)JsonStreamParser::to_number(value);
+    } else if (path == "main.humidity") {
+        pending_weather.humidity = (int)JsonStreamParser::to_number(value);
+    } else if (path == "weather[0].icon") {
+        pending_weather.icon_code = value;
+    } else if (path == "weather[0].description") {
+        pending_weather.description = value;
+    } else if (path == "name") {
+        pending_weather.location = value;
+    } else if (path == "sys.sunrise") {
+        pending_sunrise = (long)JsonStreamParser::to_number(value);
+    } else if (path == "sys.sunset") {
+        pending_sunset = (long)JsonStreamParser::to_number(value);
+    } else if (path == "timezone") {
+        pending_tz_offset = (long)JsonStreamParser::to_number(value);
+    }
+}
+
+// Format a unix timestamp as local H:MM using the API's timezone offset
+static std::string format_local_time(long timestamp, long tz_offset) {
+    long seconds_of_day = ((timestamp + tz_offset) % 86400 + 86400) % 86400;
+    int hours = (int)(seconds_of_day / 3600) % 12;
+    int minutes = (int)(seconds_of_day / 60) % 60;
+    
+    std::ostringstream out;
+    out << (hours == 0 ? 12 : hours) << ":" << std::setw(2) << std::setfill('0') << minutes;
+    return out.str();
+}
+
+void WeatherApp::finish_weather_response(bool success) {
+    fetch_in_flight = false;
+    weather_parser.finish();
+    
+    if (!success || !weather_parser.is_complete()) {
+        printf("WeatherApp: Weather response incomplete or malformed\n");
+        return;
+    }
+    
+    if (pending_sunrise != 0) {
+        pending_weather.sunrise = format_local_time(pending_sunrise, pending_tz_offset);
+    }
+    if (pending_sunset != 0) {
+        pending_weather.sunset = format_local_time(pending_sunset, pending_tz_offset);
+    }
     
-    // Update current weather with API indicator
-    current_weather.location = "NYC (API)";
-    current_weather.current_temp = 75; // Would parse from JSON
-    current_weather.description = "Live Data"; // Would parse from JSON
+    ingest.current = pending_weather;
+    data_store.weather.publish(ingest);
+    api_data_loaded = true;
+    printf("WeatherApp: Weather updated for %s\n", ingest.current.location.c_str());
 }
 
 void WeatherApp::handle_button_press(bool is_horizontal) {
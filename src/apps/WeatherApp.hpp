@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../core/BaseApp.hpp"
+#include "../core/DataStore.hpp"
+#include "../utils/json_parser.h"
 #include <map>
 #include <string>
 
@@ -12,18 +14,45 @@ public:
     WeatherApp();
     ~WeatherApp();
     
-    void draw(bool is_horizontal) override;
+    // Start using the network; the first fetch runs once WiFi is up
+    void attach_network(NetworkManager& network);
+    
+    const char* get_name() const override { return "Weather"; }
+    void draw(RenderContext& ctx, bool is_horizontal) override;
+    bool has_background(bool is_horizontal) const override;
+    void draw_background(RenderContext& ctx, bool is_horizontal) override;
     void handle_button_press(bool is_horizontal) override;
+    bool needs_redraw() const override;
+    uint32_t data_version() const override;
+    
+    // Playlist: refresh ahead of the slot; ready once no fetch is in flight.
+    // Responses are run by the NetworkManager's poll, so a prefetch lands
+    // while another app is still on screen.
+    void prefetch() override;
+    bool is_ready() const override { return !fetch_in_flight; }
+    
+    void on_exit() override;
     
 private:
-    WeatherData current_weather;
-    std::vector<WeatherData> forecast_data;
+    WeatherSnapshot ingest;          // Ingest side's copy, published to data_store.weather
+    uint32_t drawn_version;          // Store version on screen
     std::map<std::string, uint8_t*> weather_icons;
     HttpsClient* https_client;
+    NetworkManager* network;
+    uint32_t network_listener;
     bool api_data_loaded;
+    bool fetch_in_flight;
+    
+    // Streaming parse state - fields are filled in as the response arrives
+    JsonStreamParser weather_parser;
+    WeatherData pending_weather;
+    long pending_sunrise;
+    long pending_sunset;
+    long pending_tz_offset;
     
     void load_weather_icons();
     void initialize_mock_data();
     void fetch_weather_data();
-    void parse_weather_response(const std::string& json_response);
+    void handle_weather_value(const std::string& path, const std::string& value);
+    void finish_weather_response(bool success);
 };
\ No newline at end of file
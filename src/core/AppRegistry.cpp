@@ -0,0 +1,120 @@
+#include "AppRegistry.hpp"
+#include <cstdio>
+
+// Overruns are logged at most this often
+#define APP_OVERRUN_LOG_INTERVAL_MS 5000
+
+AppRegistry::AppRegistry()
+    : app_count(0)
+    , active_index(0)
+    , is_horizontal(false)
+    , entered(false)
+    , update_overruns(0)
+    , last_overrun_log_ms(0)
+    , screen_app(nullptr)
+    , screen_horizontal(false)
+    , screen_sub_state(0) {
+}
+
+bool AppRegistry::add(BaseApp* app) {
+    if (app == nullptr || app_count >= APP_REGISTRY_MAX_APPS) {
+        return false;
+    }
+    apps[app_count++] = app;
+    return true;
+}
+
+void AppRegistry::switch_to(size_t index) {
+    if (index >= app_count || (entered && index == active_index)) {
+        return;
+    }
+    
+    if (entered) {
+        apps[active_index]->on_exit();
+    }
+    active_index = index;
+    entered = true;
+    apps[active_index]->on_orientation(is_horizontal);
+    apps[active_index]->on_enter();
+    
+    printf("Switched to app: %s\n", apps[active_index]->get_name());
+}
+
+void AppRegistry::step(int delta) {
+    if (app_count == 0 || delta == 0) {
+        return;
+    }
+    
+    int next = ((int)active_index + delta) % (int)app_count;
+    if (next < 0) {
+        next += (int)app_count;
+    }
+    switch_to((size_t)next);
+}
+
+void AppRegistry::handle_button_press(bool is_horizontal) {
+    BaseApp* app = get_active();
+    if (app == nullptr || !entered) {
+        return;
+    }
+    
+    app->handle_button_press(is_horizontal);
+    app->invalidate();
+    printf("Button pressed for app: %s\n", app->get_name());
+}
+
+void AppRegistry::set_orientation(bool is_horizontal) {
+    if (is_horizontal == this->is_horizontal) {
+        return;
+    }
+    this->is_horizontal = is_horizontal;
+    
+    BaseApp* app = get_active();
+    if (app != nullptr && entered) {
+        app->on_orientation(is_horizontal);
+    }
+    if (app != nullptr) {
+        app->invalidate();
+    }
+}
+
+void AppRegistry::update(uint32_t dt_ms) {
+    if (app_count == 0 || !entered) {
+        return;
+    }
+    
+    uint32_t start_us = time_us_32();
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    for (size_t i = 0; i < app_count; i++) {
+        apps[i]->service(now);
+    }
+    apps[active_index]->update(dt_ms);
+    uint32_t elapsed_us = time_us_32() - start_us;
+    
+    if (elapsed_us > APP_UPDATE_BUDGET_US) {
+        update_overruns++;
+        if (last_overrun_log_ms == 0 || now - last_overrun_log_ms > APP_OVERRUN_LOG_INTERVAL_MS) {
+            printf("AppRegistry: update phase (%s active) took %lu us (budget %u us, %lu overruns)\n",
+                   apps[active_index]->get_name(), (unsigned long)elapsed_us, (unsigned)APP_UPDATE_BUDGET_US,
+                   (unsigned long)update_overruns);
+            last_overrun_log_ms = now;
+        }
+    }
+}
+
+bool AppRegistry::draw(RenderContext& ctx) {
+    BaseApp* app = get_active();
+    if (app == nullptr || !entered || !app->needs_redraw()) {
+        return false;
+    }
+    
+    int sub_state = app->get_sub_state();
+    bool target_current = screen_app == app && screen_horizontal == is_horizontal && screen_sub_state == sub_state;
+    bool drawn = compositor.render(ctx, app, is_horizontal, target_current);
+    app->mark_drawn();
+    
+    screen_app = app;
+    screen_horizontal = is_horizontal;
+    screen_sub_state = sub_state;
+    return drawn;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "BaseApp.hpp"
+#include "Compositor.hpp"
+
+// Most apps the encoder can cycle through
+#define APP_REGISTRY_MAX_APPS 8
+
+// Update phase target per frame. Only measured: a longer phase is counted
+// and logged (rate limited), never cut short - apps keep their calls short
+#define APP_UPDATE_BUDGET_US 20000
+
+// The apps in encoder order, and which one is on screen
+// Only the active app gets lifecycle calls, updates and draws; the others
+// only get their service() tick until they are switched to.
+class AppRegistry {
+public:
+    AppRegistry();
+    
+    // Append an app; call switch_to() once all are added to enter the first
+    bool add(BaseApp* app);
+    
+    size_t count() const { return app_count; }
+    size_t get_active_index() const { return active_index; }
+    BaseApp* get_active() const { return app_count ? apps[active_index] : nullptr; }
+    BaseApp* get(size_t index) const { return index < app_count ? apps[index] : nullptr; }
+    bool get_orientation() const { return is_horizontal; }
+    
+    // Make the app at index active (on_exit for the old one, on_enter for the new)
+    void switch_to(size_t index);
+    
+    // Move through the apps by delta steps, wrapping around (encoder turns)
+    void step(int delta);
+    
+    // Input for the active app
+    void handle_button_press(bool is_horizontal);
+    
+    // The display was turned - the active app has to redraw
+    void set_orientation(bool is_horizontal);
+    
+    // Update phase: every app's service() tick, then the active app's
+    // update(dt). The whole phase is timed against APP_UPDATE_BUDGET_US for
+    // get_update_overruns(); nothing is skipped when it runs over.
+    void update(uint32_t dt_ms);
+    
+    // Draw phase: compose the active app into the panel frame ctx if it needs it.
+    // Returns true if the frame changed and has to be sent to the panel.
+    bool draw(RenderContext& ctx);
+    
+    // Compose any app's frame into an offscreen ctx (background layer, then
+    // draw(), then the animated layer unless with_animated is false)
+    void render(BaseApp* app, RenderContext& ctx, bool is_horizontal, bool with_animated = true) {
+        compositor.render(ctx, app, is_horizontal, false, with_animated);
+    }
+    
+    // Something other than draw() wrote the panel frame
+    void forget_screen() { screen_app = nullptr; }
+    
+    // Update phases measured over APP_UPDATE_BUDGET_US (diagnostic only)
+    uint32_t get_update_overruns() const { return update_overruns; }
+
+private:
+    BaseApp* apps[APP_REGISTRY_MAX_APPS];
+    size_t app_count;
+    size_t active_index;
+    bool is_horizontal;
+    bool entered;                // on_enter has run for the active app
+    uint32_t update_overruns;
+    uint32_t last_overrun_log_ms;
+    Compositor compositor;
+    
+    // What draw() last left in the panel frame
+    BaseApp* screen_app;
+    bool screen_horizontal;
+    int screen_sub_state;
+};
@@ -4,18 +4,70 @@
 
 class BaseApp {
 public:
-    BaseApp() : sub_state(0) {}
+    BaseApp() : sub_state(0), dirty(true) {}
     virtual ~BaseApp() = default;
     
     // Pure virtual methods that each app must implement
-    virtual void draw(bool is_horizontal) = 0;
+    virtual const char* get_name() const = 0;
+    virtual void draw(RenderContext& ctx, bool is_horizontal) = 0;
     virtual void handle_button_press(bool is_horizontal) = 0;
-    virtual void reset_state() { sub_state = 0; }
+    virtual void reset_state() { sub_state = 0; invalidate(); }
+    
+    // Lifecycle hooks - only the active app is entered and updated
+    virtual void on_enter() { invalidate(); }
+    virtual void on_exit() {}
+    
+    // The display was turned; also called with the current orientation
+    // right before on_enter()
+    virtual void on_orientation(bool is_horizontal) { (void)is_horizontal; }
+    
+    // Non-drawing work (network, parsing, animation state); dt_ms since the last call.
+    // Keep each call short - the frame budget is shared with drawing.
+    virtual void update(uint32_t dt_ms) { (void)dt_ms; }
+    
+    // Background work that must keep time whichever app is on screen (data
+    // sampling and the like). Called every frame for every app, active or
+    // not, before the active app's update(); no drawing state here.
+    virtual void service(uint32_t now_ms) { (void)now_ms; }
+    
+    // Playlist support: refresh data ahead of being shown (may run while
+    // inactive - requests are serviced by the network poll in the main loop,
+    // not by update()), whether that data has landed, and its current version.
+    // The compositor replays a recorded draw() until the version changes, so
+    // draw() may only depend on it, the orientation and the sub state;
+    // apps that return 0 are drawn directly every time.
+    virtual void prefetch() {}
+    virtual bool is_ready() const { return true; }
+    virtual uint32_t data_version() const { return 0; }
+    
+    // Layered drawing: a static background (labels, axes, frames) is drawn
+    // once by draw_background() and cached by the compositor; draw() then
+    // only paints the changing values on top of a copy of it. The cached
+    // layer is redrawn when the orientation or background_key() changes.
+    virtual bool has_background(bool is_horizontal) const { (void)is_horizontal; return false; }
+    virtual void draw_background(RenderContext& ctx, bool is_horizontal) { (void)ctx; (void)is_horizontal; }
+    virtual uint32_t background_key() const { return 0; }
+    
+    // Animated layer (marquees and the like): drawn over the replayed frame
+    // every time the screen is composed, never recorded. Call invalidate()
+    // from update() when it has moved.
+    virtual bool is_animated(bool is_horizontal) const { (void)is_horizontal; return false; }
+    virtual void draw_animated(RenderContext& ctx, bool is_horizontal) { (void)ctx; (void)is_horizontal; }
+    
+    // The screen is redrawn only when the active app has changed something
+    virtual bool needs_redraw() const { return dirty; }
+    void invalidate() { dirty = true; }
+    void mark_drawn() { dirty = false; }
     
     // Common methods
     int get_sub_state() const { return sub_state; }
-    void set_sub_state(int state) { sub_state = state; }
+    // redraw = false only changes what the next draw() shows (offscreen
+    // pre-rendering), without asking for the live screen to be redrawn
+    void set_sub_state(int state, bool redraw = true) { sub_state = state; if (redraw) invalidate(); }
 
 protected:
     int sub_state;
-};
\ No newline at end of file
+
+private:
+    bool dirty;
+};
@@ -0,0 +1,135 @@
+#include "Compositor.hpp"
+#include <cstdio>
+#include <utility>
+
+Compositor::Compositor()
+    : use_counter(0) {
+    for (Recording& recording : recordings) {
+        recording.app = nullptr;
+        recording.is_horizontal = false;
+        recording.sub_state = 0;
+        recording.version = 0;
+        recording.last_used = 0;
+    }
+}
+
+void Compositor::flush() {
+    for (Layer& layer : layers) {
+        layer.app = nullptr;
+    }
+    for (Recording& recording : recordings) {
+        recording.app = nullptr;
+        recording.list.clear();
+    }
+}
+
+Compositor::Layer& Compositor::background_for(BaseApp* app, bool is_horizontal, bool& redrawn) {
+    uint32_t key = app->background_key();
+    Layer* oldest = &layers[0];
+    redrawn = false;
+    
+    for (Layer& layer : layers) {
+        if (layer.app == app && layer.is_horizontal == is_horizontal && layer.key == key) {
+            layer.last_used = ++use_counter;
+            return layer;
+        }
+        if (layer.app == nullptr || (oldest->app != nullptr && layer.last_used < oldest->last_used)) {
+            oldest = &layer;
+        }
+    }
+    
+    // Miss - draw the background into the least recently used slot
+    RenderContext& ctx = oldest->target.get_context();
+    ctx.clear();
+    app->draw_background(ctx, is_horizontal);
+    oldest->app = app;
+    oldest->is_horizontal = is_horizontal;
+    oldest->key = key;
+    oldest->last_used = ++use_counter;
+    redrawn = true;
+    printf("Compositor: cached background for %s\n", app->get_name());
+    return *oldest;
+}
+
+Compositor::Recording& Compositor::recording_for(BaseApp* app, bool is_horizontal) {
+    int sub_state = app->get_sub_state();
+    Recording* oldest = &recordings[0];
+    
+    for (Recording& recording : recordings) {
+        if (recording.app == app && recording.is_horizontal == is_horizontal && recording.sub_state == sub_state) {
+            recording.last_used = ++use_counter;
+            return recording;
+        }
+        if (recording.app == nullptr || (oldest->app != nullptr && recording.last_used < oldest->last_used)) {
+            oldest = &recording;
+        }
+    }
+    
+    // Miss - reuse the least recently used slot; version 0 forces a recording
+    oldest->app = app;
+    oldest->is_horizontal = is_horizontal;
+    oldest->sub_state = sub_state;
+    oldest->version = 0;
+    oldest->last_used = ++use_counter;
+    oldest->list.clear();
+    return *oldest;
+}
+
+bool Compositor::record(RenderContext& ctx, BaseApp* app, bool is_horizontal, Recording& recording) {
+    // Taken before drawing: a publish during the draw leaves the recording stale
+    uint32_t version = app->data_version();
+    
+    scratch.clear();
+    ctx.set_recorder(&scratch);
+    app->draw(ctx, is_horizontal);
+    ctx.set_recorder(nullptr);
+    scratch.finish();
+    recording.version = version;
+    
+    if (!DisplayList::damage(recording.list, scratch, last_damage)) {
+        return false;
+    }
+    std::swap(recording.list, scratch);
+    return true;
+}
+
+bool Compositor::render(RenderContext& ctx, BaseApp* app, bool is_horizontal, bool target_current,
+                        bool with_animated) {
+    // Unversioned apps draw from state the compositor can't see - no recording
+    if (app->data_version() == 0) {
+        bool redrawn;
+        if (!app->has_background(is_horizontal) || !background_for(app, is_horizontal, redrawn).target.copy_to(ctx)) {
+            ctx.clear();
+            app->draw_background(ctx, is_horizontal);
+        }
+        app->draw(ctx, is_horizontal);
+        if (with_animated && app->is_animated(is_horizontal)) {
+            app->draw_animated(ctx, is_horizontal);
+        }
+        return true;
+    }
+    
+    Recording& recording = recording_for(app, is_horizontal);
+    bool changed = recording.list.empty();
+    if (recording.version != app->data_version()) {
+        changed = record(ctx, app, is_horizontal, recording) || changed;
+    }
+    
+    bool background_redrawn = false;
+    Layer* background = app->has_background(is_horizontal) ? &background_for(app, is_horizontal, background_redrawn) : nullptr;
+    bool animated = with_animated && app->is_animated(is_horizontal);
+    if (target_current && !changed && !background_redrawn && !animated) {
+        return false;
+    }
+    
+    // Targets that can't take a whole-frame copy get the background drawn in place
+    if (background == nullptr || !background->target.copy_to(ctx)) {
+        ctx.clear();
+        app->draw_background(ctx, is_horizontal);
+    }
+    recording.list.replay(ctx);
+    if (animated) {
+        app->draw_animated(ctx, is_horizontal);
+    }
+    return true;
+}
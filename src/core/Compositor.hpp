@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BaseApp.hpp"
+#include "RenderContext.hpp"
+#include "DisplayList.hpp"
+
+// Cached background layers - enough for the active app and the one the
+// playlist pre-renders next
+#define COMPOSITOR_CACHE_SLOTS 2
+
+// Recorded dynamic layers - one per app, orientation and sub state
+#define COMPOSITOR_RECORDING_SLOTS 4
+
+// Builds frames from layers: an app's static background, rendered once and
+// kept offscreen, then the dynamic draw() on top. A frame costs one copy of
+// the background plus the few values that change, instead of every label.
+// The dynamic layer is recorded into a display list when the app's data
+// version changes and replayed otherwise, so layout code only runs for new
+// data - and a new recording identical to the old one draws nothing at all.
+// Animated layers are drawn last, fresh every time.
+class Compositor {
+public:
+    Compositor();
+    
+    // Compose one frame of app into ctx. If target_current is set, ctx still
+    // holds this app's last frame, and nothing is drawn when the frame would
+    // come out the same. with_animated = false leaves out the animated layer
+    // (its state belongs to the live screen). Returns true if ctx was drawn.
+    bool render(RenderContext& ctx, BaseApp* app, bool is_horizontal, bool target_current = false,
+                bool with_animated = true);
+    
+    // Panel area that changed in the last recording that differed from its predecessor
+    const Rect& get_last_damage() const { return last_damage; }
+    
+    // Forget every cached background (e.g. after a theme change)
+    void flush();
+
+private:
+    struct Layer {
+        Layer() : target(DISPLAY_WIDTH, DISPLAY_HEIGHT), app(nullptr), is_horizontal(false), key(0), last_used(0) {}
+        
+        OffscreenTarget target;
+        BaseApp* app;                // nullptr = empty
+        bool is_horizontal;
+        uint32_t key;                // App's background_key() when drawn
+        uint32_t last_used;
+    };
+    
+    struct Recording {
+        BaseApp* app;                // nullptr = empty
+        bool is_horizontal;
+        int sub_state;
+        uint32_t version;            // App's data_version() when recorded
+        uint32_t last_used;
+        DisplayList list;
+    };
+    
+    Layer layers[COMPOSITOR_CACHE_SLOTS];
+    Recording recordings[COMPOSITOR_RECORDING_SLOTS];
+    DisplayList scratch;             // Next recording, compared with the cached one
+    Rect last_damage;
+    uint32_t use_counter;
+    
+    Layer& background_for(BaseApp* app, bool is_horizontal, bool& redrawn);
+    Recording& recording_for(BaseApp* app, bool is_horizontal);
+    bool record(RenderContext& ctx, BaseApp* app, bool is_horizontal, Recording& recording);
+};
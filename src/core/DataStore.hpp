@@ -0,0 +1,102 @@
+#pragma once
+
+#include "common.hpp"
+#include "../utils/time_series.h"
+#include <atomic>
+#include <cstdint>
+
+// One published record: a single writer (network ingest) hands complete
+// snapshots to a single reader (the renderer), which may run on the other core.
+// Three buffers rotate between the two sides - the writer fills its own, then
+// swaps it into the middle; the reader swaps the middle out when it is fresh.
+// Neither side ever waits for the other, and the reader always sees a whole
+// snapshot. Unlike a seqlock this also works for records that own memory
+// (std::string, std::vector), since no buffer is ever read while written.
+template <typename T>
+class DataSlot {
+public:
+    DataSlot()
+        : write_index(0)
+        , read_index(1)
+        , middle(2)
+        , published_version(0) {
+        buffers[0].version = 0;
+        buffers[1].version = 0;
+        buffers[2].version = 0;
+    }
+    
+    // Writer side: publish a complete snapshot
+    void publish(const T& value) {
+        Buffer& buffer = buffers[write_index];
+        buffer.value = value;
+        buffer.version = published_version.load(std::memory_order_relaxed) + 1;
+        
+        // Hand the buffer over and take back whatever the reader left
+        uint8_t previous = middle.exchange(write_index | FRESH, std::memory_order_acq_rel);
+        write_index = previous & INDEX_MASK;
+        published_version.store(buffer.version, std::memory_order_release);
+    }
+    
+    // Reader side: the newest snapshot, valid until the next read()
+    const T& read() {
+        if (middle.load(std::memory_order_acquire) & FRESH) {
+            uint8_t previous = middle.exchange(read_index, std::memory_order_acq_rel);
+            read_index = previous & INDEX_MASK;
+        }
+        return buffers[read_index].value;
+    }
+    
+    // Version of the snapshot the last read() returned (0 = nothing published)
+    uint32_t read_version() const { return buffers[read_index].version; }
+    
+    // Version of the newest snapshot - compare with what was drawn to skip work
+    uint32_t latest_version() const { return published_version.load(std::memory_order_acquire); }
+    
+private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+    
+    struct Buffer {
+        T value;
+        uint32_t version;
+    };
+    
+    Buffer buffers[3];
+    uint8_t write_index;             // Writer's own buffer
+    uint8_t read_index;              // Reader's own buffer
+    std::atomic<uint8_t> middle;     // Buffer in between, plus FRESH once written
+    std::atomic<uint32_t> published_version;
+};
+
+// Everything the apps show, as published by their network code
+struct WeatherSnapshot {
+    WeatherData current;
+    std::vector<WeatherData> forecast;
+};
+
+// One asset's chart at the selected timeframe, downsampled for each view
+#define CHART_WIDE_POINTS 54     // Horizontal price chart
+#define CHART_LIST_POINTS 12     // Vertical list sparklines
+
+struct TimeframeChart {
+    float wide[CHART_WIDE_POINTS];
+    float narrow[CHART_LIST_POINTS];
+    uint8_t wide_count;
+    uint8_t narrow_count;
+};
+
+struct AssetSnapshot {
+    std::vector<AssetData> assets;
+    std::vector<PriceSeries> history;    // Price samples, same order as assets
+    Timeframe timeframe = Timeframe::TICKS;
+    std::vector<TimeframeChart> charts;  // At timeframe, same order as assets (none for TICKS)
+};
+
+struct DataStore {
+    DataSlot<WeatherSnapshot> weather;
+    DataSlot<AssetSnapshot> stocks;
+    DataSlot<AssetSnapshot> crypto;
+};
+
+// Defined ahead of the apps in main.cpp so it is constructed before them
+extern DataStore data_store;
@@ -0,0 +1,245 @@
+#include "DisplayList.hpp"
+#include "../utils/text_renderer.h"
+#include <algorithm>
+#include <cstdio>
+
+// Decoded weather icons are 21x21
+#define DISPLAY_LIST_ICON_SIZE 21
+
+// Upper bound of a font6 glyph, for damage only
+#define DISPLAY_LIST_FONT6_WIDTH 6
+#define DISPLAY_LIST_FONT6_HEIGHT 7
+
+// Grow area to also cover extra
+static void add_area(Rect& area, const Rect& extra) {
+    if (extra.empty()) {
+        return;
+    }
+    if (area.empty()) {
+        area = extra;
+        return;
+    }
+    int x0 = std::min(area.x, extra.x);
+    int y0 = std::min(area.y, extra.y);
+    int x1 = std::max(area.x + area.w, extra.x + extra.w);
+    int y1 = std::max(area.y + area.h, extra.y + extra.h);
+    area = Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+// A logical rectangle as it lands on the panel
+static Rect rotate_rect(int x, int y, int w, int h, RotationMode rotation) {
+    if (w <= 0 || h <= 0) {
+        return Rect();
+    }
+    Point a = rotation == RotationMode::VERTICAL_CLOCKWISE ? rotate_vertical(x, y) : rotate_180(x, y);
+    Point b = rotation == RotationMode::VERTICAL_CLOCKWISE ? rotate_vertical(x + w - 1, y + h - 1) : rotate_180(x + w - 1, y + h - 1);
+    int x0 = std::min(a.x, b.x);
+    int y0 = std::min(a.y, b.y);
+    return Rect(x0, y0, std::max(a.x, b.x) - x0 + 1, std::max(a.y, b.y) - y0 + 1);
+}
+
+void DisplayList::clear() {
+    commands.clear();
+    strings.clear();
+}
+
+void DisplayList::add_text_command(Op op, int x, int y, const std::string& text, uint8_t mode, uint8_t r, uint8_t g, uint8_t b) {
+    merge_last_run();
+    
+    Command command = {};
+    command.op = op;
+    command.mode = mode;
+    command.x = (int16_t)x;
+    command.y = (int16_t)y;
+    command.r = r;
+    command.g = g;
+    command.b = b;
+    command.text_offset = (uint16_t)strings.size();
+    command.text_length = (uint16_t)text.size();
+    strings += text;
+    commands.push_back(command);
+}
+
+void DisplayList::text(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+    add_text_command(Op::TEXT, x, y, text, (uint8_t)rotation, r, g, b);
+}
+
+void DisplayList::string(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+    add_text_command(Op::STRING, x, y, text, rotate ? 1 : 0, r, g, b);
+}
+
+void DisplayList::icon(int x, int y, const std::string& icon_code, bool rotate) {
+    add_text_command(Op::ICON, x, y, icon_code, rotate ? 1 : 0, 0, 0, 0);
+}
+
+void DisplayList::pixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+    uint8_t mode = (uint8_t)rotation;
+    
+    // Extend the current run to the right
+    if (!commands.empty()) {
+        Command& last = commands.back();
+        if (last.op == Op::RECT && last.h == 1 && last.y == y && last.x + last.w == x &&
+            last.mode == mode && last.r == r && last.g == g && last.b == b) {
+            last.w++;
+            return;
+        }
+    }
+    
+    merge_last_run();
+    
+    Command command = {};
+    command.op = Op::RECT;
+    command.mode = mode;
+    command.x = (int16_t)x;
+    command.y = (int16_t)y;
+    command.w = 1;
+    command.h = 1;
+    command.r = r;
+    command.g = g;
+    command.b = b;
+    commands.push_back(command);
+}
+
+// A finished single-row run directly below a rectangle of the same width
+// and colour becomes that rectangle's next row
+void DisplayList::merge_last_run() {
+    if (commands.size() < 2) {
+        return;
+    }
+    const Command& run = commands[commands.size() - 1];
+    Command& rect = commands[commands.size() - 2];
+    if (run.op == Op::RECT && rect.op == Op::RECT && run.h == 1 &&
+        run.x == rect.x && run.w == rect.w && run.y == rect.y + rect.h &&
+        run.mode == rect.mode && run.r == rect.r && run.g == rect.g && run.b == rect.b) {
+        rect.h++;
+        commands.pop_back();
+    }
+}
+
+void DisplayList::finish() {
+    merge_last_run();
+}
+
+std::string DisplayList::text_of(const Command& command) const {
+    return strings.substr(command.text_offset, command.text_length);
+}
+
+void DisplayList::replay(RenderContext& ctx) const {
+    for (const Command& command : commands) {
+        switch (command.op) {
+            case Op::TEXT:
+                draw_text_bitmap_mode(ctx, command.x, command.y, text_of(command),
+                                      command.r, command.g, command.b, (RotationMode)command.mode);
+                break;
+            case Op::STRING:
+                draw_string(ctx, command.x, command.y, text_of(command),
+                            command.r, command.g, command.b, command.mode != 0);
+                break;
+            case Op::ICON:
+                draw_weather_icon(ctx, command.x, command.y, text_of(command), command.mode != 0);
+                break;
+            case Op::RECT:
+                for (int y = command.y; y < command.y + command.h; y++) {
+                    for (int x = command.x; x < command.x + command.w; x++) {
+                        draw_pixel_mode(ctx, x, y, command.r, command.g, command.b, (RotationMode)command.mode);
+                    }
+                }
+                break;
+        }
+    }
+}
+
+bool DisplayList::same_command(size_t index, const DisplayList& other, size_t other_index) const {
+    const Command& a = commands[index];
+    const Command& b = other.commands[other_index];
+    if (a.op != b.op || a.mode != b.mode || a.x != b.x || a.y != b.y || a.w != b.w || a.h != b.h ||
+        a.r != b.r || a.g != b.g || a.b != b.b || a.text_length != b.text_length) {
+        return false;
+    }
+    return strings.compare(a.text_offset, a.text_length, other.strings, b.text_offset, b.text_length) == 0;
+}
+
+bool DisplayList::operator==(const DisplayList& other) const {
+    if (commands.size() != other.commands.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (!same_command(i, other, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Rect DisplayList::panel_bounds(const Command& command) const {
+    switch (command.op) {
+        case Op::TEXT:
+            return rotate_rect(command.x, command.y, measure_text_width(text_of(command)), BITMAP_FONT_HEIGHT,
+                               (RotationMode)command.mode);
+        case Op::STRING: {
+            // draw_string only moves the anchor when rotating; the text itself is upright
+            Point anchor = command.mode ? rotate_180(command.x, command.y) : Point(command.x, command.y);
+            return Rect(anchor.x, anchor.y, DISPLAY_LIST_FONT6_WIDTH * command.text_length, DISPLAY_LIST_FONT6_HEIGHT);
+        }
+        case Op::ICON:
+            return rotate_rect(command.x, command.y, DISPLAY_LIST_ICON_SIZE, DISPLAY_LIST_ICON_SIZE,
+                               RotationMode::HORIZONTAL_UPSIDE_DOWN);
+        case Op::RECT:
+            return rotate_rect(command.x, command.y, command.w, command.h, (RotationMode)command.mode);
+    }
+    return Rect();
+}
+
+bool DisplayList::damage(const DisplayList& before, const DisplayList& after, Rect& area) {
+    area = Rect();
+    size_t count = std::max(before.commands.size(), after.commands.size());
+    
+    // Commands are compared in order - a change shifts everything after it
+    for (size_t i = 0; i < count; i++) {
+        bool in_before = i < before.commands.size();
+        bool in_after = i < after.commands.size();
+        if (in_before && in_after && before.same_command(i, after, i)) {
+            continue;
+        }
+        if (in_before) {
+            add_area(area, before.panel_bounds(before.commands[i]));
+        }
+        if (in_after) {
+            add_area(area, after.panel_bounds(after.commands[i]));
+        }
+    }
+    
+    // Clip to the panel
+    int x0 = std::max(0, (int)area.x);
+    int y0 = std::max(0, (int)area.y);
+    int x1 = std::min(DISPLAY_WIDTH, (int)(area.x + area.w));
+    int y1 = std::min(DISPLAY_HEIGHT, (int)(area.y + area.h));
+    area = x1 > x0 && y1 > y0 ? Rect(x0, y0, x1 - x0, y1 - y0) : Rect();
+    return !area.empty();
+}
+
+std::string DisplayList::serialize() const {
+    static const char* op_names[] = { "TEXT", "STRING", "ICON", "RECT" };
+    std::string out;
+    char line[64];
+    
+    for (const Command& command : commands) {
+        snprintf(line, sizeof(line), "%s %d,%d", op_names[(int)command.op], command.x, command.y);
+        out += line;
+        if (command.op == Op::RECT) {
+            snprintf(line, sizeof(line), " %dx%d", command.w, command.h);
+            out += line;
+        }
+        if (command.op != Op::ICON) {
+            snprintf(line, sizeof(line), " mode=%u #%02x%02x%02x", command.mode, command.r, command.g, command.b);
+        } else {
+            snprintf(line, sizeof(line), " mode=%u", command.mode);
+        }
+        out += line;
+        if (command.op != Op::RECT) {
+            out += " \"" + text_of(command) + "\"";
+        }
+        out += "\n";
+    }
+    return out;
+}
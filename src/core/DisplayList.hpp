@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A recorded frame: the drawing calls an app's draw() made, kept so the
+// frame can be replayed without running its layout code again.
+// While a RenderContext records (set_recorder), the drawing helpers append
+// a command here instead of touching pixels. Pixels are merged into
+// rectangles as they come in, so a filled bar is one command, not hundreds.
+// Two lists can be compared for equality or for the panel area they differ
+// in, and serialised to text for golden files on the host.
+class DisplayList {
+public:
+    enum class Op : uint8_t {
+        TEXT,       // Bitmap font text (draw_text_bitmap_mode)
+        STRING,     // Pimoroni font text (draw_string)
+        ICON,       // Weather icon (draw_weather_icon)
+        RECT        // Solid rectangle of pixels (draw_pixel_mode)
+    };
+    
+    struct Command {
+        Op op;
+        uint8_t mode;            // RotationMode for TEXT/RECT, rotate flag for STRING/ICON
+        int16_t x;
+        int16_t y;
+        int16_t w;               // RECT only
+        int16_t h;
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+        uint16_t text_offset;    // TEXT/STRING/ICON: text in the string pool
+        uint16_t text_length;
+    };
+    
+    void clear();
+    bool empty() const { return commands.empty(); }
+    size_t size() const { return commands.size(); }
+    
+    // Recording - called by the drawing helpers
+    void text(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation);
+    void string(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate);
+    void icon(int x, int y, const std::string& icon_code, bool rotate);
+    void pixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation);
+    
+    // Call once recording is done - merges the last pixel run
+    void finish();
+    
+    // Draw every command into ctx (which must not be recording into this list)
+    void replay(RenderContext& ctx) const;
+    
+    bool operator==(const DisplayList& other) const;
+    bool operator!=(const DisplayList& other) const { return !(*this == other); }
+    
+    // Panel area (after rotation) covered by commands that differ between
+    // two lists. Returns false if the lists draw the same thing.
+    static bool damage(const DisplayList& before, const DisplayList& after, Rect& area);
+    
+    // One line per command, e.g. "TEXT 3,10 mode=0 #ffffff \"RAIN\""
+    std::string serialize() const;
+
+private:
+    std::vector<Command> commands;
+    std::string strings;         // Text of all commands, back to back
+    
+    void add_text_command(Op op, int x, int y, const std::string& text, uint8_t mode, uint8_t r, uint8_t g, uint8_t b);
+    std::string text_of(const Command& command) const;
+    bool same_command(size_t index, const DisplayList& other, size_t other_index) const;
+    Rect panel_bounds(const Command& command) const;
+    void merge_last_run();
+};
@@ -0,0 +1,151 @@
+#include "Playlist.hpp"
+#include <cstdio>
+
+// A slot whose data is still loading keeps the previous one on screen this long at most
+#define PLAYLIST_MAX_WAIT_MS 10000
+
+Playlist::Playlist(AppRegistry& registry)
+    : registry(registry)
+    , slot_count(0)
+    , current_slot(0)
+    , enabled(true)
+    , started(false)
+    , slot_started_ms(0)
+    , paused_until_ms(0)
+    , prefetched(false)
+    , prerendered(false)
+    , prerender_horizontal(false)
+    , prerender_version(0)
+    , offscreen(DISPLAY_WIDTH, DISPLAY_HEIGHT) {
+}
+
+bool Playlist::add(size_t app_index, int sub_state, uint32_t duration_ms) {
+    if (slot_count >= PLAYLIST_MAX_SLOTS || app_index >= registry.count()) {
+        return false;
+    }
+    slots[slot_count++] = { app_index, sub_state, duration_ms };
+    return true;
+}
+
+void Playlist::set_enabled(bool enabled) {
+    this->enabled = enabled;
+    started = false;
+}
+
+void Playlist::on_user_input(uint32_t now_ms) {
+    paused_until_ms = now_ms + PLAYLIST_RESUME_AFTER_INPUT_MS;
+    if (paused_until_ms == 0) {
+        paused_until_ms = 1;
+    }
+    prefetched = false;
+    prerendered = false;
+}
+
+void Playlist::start_slot(size_t index, uint32_t now_ms) {
+    current_slot = index;
+    slot_started_ms = now_ms;
+    prefetched = false;
+    
+    const Slot& slot = slots[index];
+    registry.switch_to(slot.app_index);
+    BaseApp* app = registry.get(slot.app_index);
+    if (app->get_sub_state() != slot.sub_state) {
+        app->set_sub_state(slot.sub_state);
+    }
+}
+
+void Playlist::prerender(const Slot& slot) {
+    BaseApp* app = registry.get(slot.app_index);
+    bool is_active = app == registry.get_active();
+    int active_sub_state = app->get_sub_state();
+    
+    // Taken before drawing: a publish during the draw makes the frame stale
+    prerender_version = app->data_version();
+    prerender_horizontal = registry.get_orientation();
+    
+    // Drawn into its own buffer - the panel frame and the app's live state
+    // are left alone: the sub state is swapped without a redraw, and the
+    // animated layer (marquees, which keep their scroll position) is left
+    // for the live screen to draw once the slot is shown
+    RenderContext& ctx = offscreen.get_context();
+    app->set_sub_state(slot.sub_state, false);
+    registry.render(app, ctx, prerender_horizontal, false);
+    
+    if (is_active) {
+        // Same app, other view - its own screen is still the one showing
+        app->set_sub_state(active_sub_state, false);
+    }
+    prerendered = true;
+}
+
+bool Playlist::show_prerendered(const Slot& slot, RenderContext& screen) {
+    BaseApp* app = registry.get(slot.app_index);
+    bool valid = prerendered && prerender_horizontal == registry.get_orientation() &&
+                 prerender_version == app->data_version();
+    if (!valid) {
+        return false;
+    }
+    
+    if (!offscreen.copy_to(screen)) {
+        return false;
+    }
+    registry.forget_screen();
+    
+    // An animated layer was left out of the frame - the next draw adds it
+    if (!app->is_animated(prerender_horizontal)) {
+        app->mark_drawn();
+    }
+    return true;
+}
+
+bool Playlist::update(uint32_t now_ms, bool idle, RenderContext& screen) {
+    if (!enabled || slot_count == 0) {
+        return false;
+    }
+    
+    if (!started) {
+        start_slot(0, now_ms);
+        started = true;
+        return false;
+    }
+    
+    if (paused_until_ms != 0) {
+        if ((int32_t)(now_ms - paused_until_ms) < 0) {
+            return false;
+        }
+        // Resume with a full slot for whatever the user left on screen
+        paused_until_ms = 0;
+        slot_started_ms = now_ms;
+    }
+    
+    size_t next_index = (current_slot + 1) % slot_count;
+    const Slot& next = slots[next_index];
+    BaseApp* next_app = registry.get(next.app_index);
+    
+    uint32_t elapsed = now_ms - slot_started_ms;
+    uint32_t duration = slots[current_slot].duration_ms;
+    uint32_t remaining = elapsed < duration ? duration - elapsed : 0;
+    
+    if (!prefetched && remaining <= PLAYLIST_PREFETCH_LEAD_MS) {
+        next_app->prefetch();
+        prefetched = true;
+    }
+    
+    if (!prerendered && idle && remaining <= PLAYLIST_PRERENDER_LEAD_MS && next_app->is_ready()) {
+        prerender(next);
+    }
+    
+    if (remaining > 0) {
+        return false;
+    }
+    
+    // Hold the current slot while the next one's data is still loading
+    if (!next_app->is_ready() && elapsed < duration + PLAYLIST_MAX_WAIT_MS) {
+        return false;
+    }
+    
+    start_slot(next_index, now_ms);
+    bool shown = show_prerendered(next, screen);
+    prerendered = false;
+    return shown;
+}
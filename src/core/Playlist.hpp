@@ -0,0 +1,67 @@
+#pragma once
+
+#include "AppRegistry.hpp"
+#include "RenderContext.hpp"
+
+// Longest a playlist can get
+#define PLAYLIST_MAX_SLOTS 16
+
+// The next app is asked to refresh its data this long before its slot starts
+#define PLAYLIST_PREFETCH_LEAD_MS 5000
+
+// ...and drawn offscreen in the last idle frame of this window
+#define PLAYLIST_PRERENDER_LEAD_MS 1000
+
+// Turning the encoder or pressing the button holds the playlist this long
+#define PLAYLIST_RESUME_AFTER_INPUT_MS 60000
+
+// Unattended rotation through the apps and their views
+// Each slot shows one app with a given sub state (e.g. one asset of a list)
+// for a while. Ahead of every change the next app prefetches its data and,
+// once that has landed, its screen is drawn into an offscreen buffer during
+// an idle frame - the change itself is a copy, never a fetch or a redraw.
+class Playlist {
+public:
+    explicit Playlist(AppRegistry& registry);
+    
+    // Append a slot: app_index in the registry, its sub state and how long to show it
+    bool add(size_t app_index, int sub_state, uint32_t duration_ms);
+    
+    void set_enabled(bool enabled);
+    bool is_enabled() const { return enabled; }
+    
+    // The user took over - pause the rotation for a while
+    void on_user_input(uint32_t now_ms);
+    
+    // Advance the schedule. idle is true when this frame drew nothing, so
+    // there is time to pre-render. Returns true if screen now holds a
+    // finished frame for the panel (a pre-rendered slot was shown).
+    bool update(uint32_t now_ms, bool idle, RenderContext& screen);
+    
+private:
+    struct Slot {
+        size_t app_index;
+        int sub_state;
+        uint32_t duration_ms;
+    };
+    
+    AppRegistry& registry;
+    Slot slots[PLAYLIST_MAX_SLOTS];
+    size_t slot_count;
+    size_t current_slot;
+    bool enabled;
+    bool started;
+    uint32_t slot_started_ms;
+    uint32_t paused_until_ms;        // 0 = not paused
+    
+    // Next slot's preparation
+    bool prefetched;
+    bool prerendered;
+    bool prerender_horizontal;       // Orientation the offscreen frame was drawn for
+    uint32_t prerender_version;      // App data version it shows
+    OffscreenTarget offscreen;       // Next slot's frame, drawn ahead
+    
+    void start_slot(size_t index, uint32_t now_ms);
+    void prerender(const Slot& slot);
+    bool show_prerendered(const Slot& slot, RenderContext& screen);
+};
@@ -0,0 +1,23 @@
+#include "RenderContext.hpp"
+#include <cstring>
+
+bool OffscreenTarget::copy_to(PicoGraphics_PenRGB888& destination) const {
+    if (destination.bounds.w != graphics.bounds.w || destination.bounds.h != graphics.bounds.h) {
+        return false;
+    }
+    memcpy(destination.frame_buffer, graphics.frame_buffer, get_buffer_size());
+    return true;
+}
+
+bool OffscreenTarget::copy_from(const PicoGraphics_PenRGB888& source) {
+    if (source.bounds.w != graphics.bounds.w || source.bounds.h != graphics.bounds.h) {
+        return false;
+    }
+    memcpy(graphics.frame_buffer, source.frame_buffer, get_buffer_size());
+    return true;
+}
+
+bool OffscreenTarget::copy_to(RenderContext& destination) const {
+    PicoGraphics_PenRGB888* surface = destination.rgb888_target();
+    return surface != nullptr && copy_to(*surface);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "libraries/pico_graphics/pico_graphics.hpp"
+#include <cstdint>
+#include <cstddef>
+
+using namespace pimoroni;
+
+class DisplayList;
+
+// Where a draw() call lands
+// Every drawing helper takes one of these instead of writing to the global
+// framebuffer, so the same app code can render to the live panel buffer, an
+// offscreen target, a sprite cache or a host-side capture surface - any
+// PicoGraphics. The context holds no pixels itself and is cheap to pass.
+class RenderContext {
+public:
+    explicit RenderContext(PicoGraphics& target) : surface(target), rgb888(nullptr), recorder(nullptr) {}
+    explicit RenderContext(PicoGraphics_PenRGB888& target) : surface(target), rgb888(&target), recorder(nullptr) {}
+    
+    PicoGraphics& target() { return surface; }
+    // The target as an RGB888 surface, if it is one (whole frames can be copied in)
+    PicoGraphics_PenRGB888* rgb888_target() { return rgb888; }
+    int width() const { return surface.bounds.w; }
+    int height() const { return surface.bounds.h; }
+    
+    // While set, drawing helpers append to this list instead of drawing
+    void set_recorder(DisplayList* list) { recorder = list; }
+    DisplayList* get_recorder() { return recorder; }
+    
+    // Fill the whole target with black
+    void clear() {
+        surface.set_pen(0, 0, 0);
+        surface.clear();
+    }
+
+private:
+    PicoGraphics& surface;
+    PicoGraphics_PenRGB888* rgb888;
+    DisplayList* recorder;
+};
+
+// A panel-sized RGB888 surface with its own buffer
+// Renders exactly like the live framebuffer, and copies onto it in one go.
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height)
+        : graphics(width, height, nullptr)
+        , context(graphics) {}
+    
+    RenderContext& get_context() { return context; }
+    void* get_buffer() { return graphics.frame_buffer; }
+    const void* get_buffer() const { return graphics.frame_buffer; }
+    size_t get_buffer_size() const { return PicoGraphics_PenRGB888::buffer_size(graphics.bounds.w, graphics.bounds.h); }
+    
+    // Copy the whole frame onto a surface of the same size and format.
+    // Returns false (and copies nothing) if the destination doesn't match.
+    bool copy_to(PicoGraphics_PenRGB888& destination) const;
+    bool copy_to(RenderContext& destination) const;
+    bool copy_from(const PicoGraphics_PenRGB888& source);
+
+private:
+    PicoGraphics_PenRGB888 graphics;
+    RenderContext context;
+};
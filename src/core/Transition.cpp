@@ -0,0 +1,205 @@
+#include "Transition.hpp"
+#include "pico/stdlib.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Smoothstep on 0..256 fixed point: 3t^2 - 2t^3, slow at both ends
+static uint32_t ease(uint32_t t) {
+    return (t * t * (768 - 2 * t)) >> 16;
+}
+
+TransitionEngine::TransitionEngine(int width, int height)
+    : from(width, height)
+    , to(width, height)
+    , width(width)
+    , height(height)
+    , type(TransitionType::CUT)
+    , direction(1)
+    , running(false)
+    , start_ms(0)
+    , duration_ms(0)
+    , frame_count(0)
+    , total_us(0)
+    , worst_us(0) {
+}
+
+const char* TransitionEngine::get_type_name(TransitionType type) {
+    switch (type) {
+        case TransitionType::CUT: return "cut";
+        case TransitionType::SLIDE: return "slide";
+        case TransitionType::PUSH: return "push";
+        case TransitionType::CROSSFADE: return "crossfade";
+        case TransitionType::ROTATE: return "rotate";
+    }
+    return "unknown";
+}
+
+void TransitionEngine::capture_from(const PicoGraphics_PenRGB888& source) {
+    from.copy_from(source);
+}
+
+void TransitionEngine::start(TransitionType type, int direction, uint32_t duration_ms, uint32_t now_ms) {
+    this->type = type;
+    this->direction = direction < 0 ? -1 : 1;
+    this->duration_ms = duration_ms;
+    start_ms = now_ms;
+    running = true;
+    frame_count = 0;
+    total_us = 0;
+    worst_us = 0;
+}
+
+bool TransitionEngine::compose(PicoGraphics_PenRGB888& destination, uint32_t now_ms) {
+    if (!running) {
+        return false;
+    }
+    
+    uint32_t elapsed = now_ms - start_ms;
+    if (type == TransitionType::CUT || elapsed >= duration_ms ||
+        destination.bounds.w != width || destination.bounds.h != height) {
+        // Done - leave the incoming frame on the panel
+        to.copy_to(destination);
+        running = false;
+        if (frame_count > 0) {
+            printf("Transition: %s, %lu frames, worst %lu us, mean %lu us (budget %u us)\n",
+                   get_type_name(type), (unsigned long)frame_count, (unsigned long)worst_us,
+                   (unsigned long)(total_us / frame_count), (unsigned)TRANSITION_FRAME_BUDGET_US);
+        }
+        return false;
+    }
+    
+    uint32_t start_us = time_us_32();
+    compose_at((uint32_t*)destination.frame_buffer, ease(elapsed * 256 / duration_ms));
+    uint32_t frame_us = time_us_32() - start_us;
+    
+    frame_count++;
+    total_us += frame_us;
+    if (frame_us > worst_us) {
+        worst_us = frame_us;
+    }
+    return true;
+}
+
+void TransitionEngine::compose_at(uint32_t* out, uint32_t progress) const {
+    switch (type) {
+        case TransitionType::SLIDE:
+            shift(out, progress, false);
+            break;
+        case TransitionType::PUSH:
+            shift(out, progress, true);
+            break;
+        case TransitionType::CROSSFADE:
+            blend(out, progress);
+            break;
+        case TransitionType::ROTATE:
+            fold(out, progress);
+            break;
+        case TransitionType::CUT:
+            memcpy(out, to.get_buffer(), to.get_buffer_size());
+            break;
+    }
+}
+
+// Whole-row copies: the incoming frame covers `shown` columns at one edge,
+// the outgoing frame stays put (slide) or moves over by the same amount (push)
+void TransitionEngine::shift(uint32_t* out, uint32_t progress, bool push) const {
+    const uint32_t* old_pixels = (const uint32_t*)from.get_buffer();
+    const uint32_t* new_pixels = (const uint32_t*)to.get_buffer();
+    int shown = (width * (int)progress) >> 8;
+    int kept = width - shown;
+    
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = out + y * width;
+        const uint32_t* old_row = old_pixels + y * width;
+        const uint32_t* new_row = new_pixels + y * width;
+        
+        if (direction > 0) {
+            memcpy(row, old_row + (push ? shown : 0), kept * sizeof(uint32_t));
+            memcpy(row + kept, new_row, shown * sizeof(uint32_t));
+        } else {
+            memcpy(row, new_row + kept, shown * sizeof(uint32_t));
+            memcpy(row + shown, old_row + (push ? 0 : shown), kept * sizeof(uint32_t));
+        }
+    }
+}
+
+// Red and blue share one multiply, green gets the other: 0x00RRGGBB pixels,
+// 8.8 fixed-point weights that add up to 256
+void TransitionEngine::blend(uint32_t* out, uint32_t progress) const {
+    const uint32_t* old_pixels = (const uint32_t*)from.get_buffer();
+    const uint32_t* new_pixels = (const uint32_t*)to.get_buffer();
+    uint32_t new_weight = progress;
+    uint32_t old_weight = 256 - progress;
+    int count = width * height;
+    
+    for (int i = 0; i < count; i++) {
+        uint32_t a = old_pixels[i];
+        uint32_t b = new_pixels[i];
+        uint32_t rb = (((a & 0xFF00FF) * old_weight + (b & 0xFF00FF) * new_weight) >> 8) & 0xFF00FF;
+        uint32_t g = (((a & 0x00FF00) * old_weight + (b & 0x00FF00) * new_weight) >> 8) & 0x00FF00;
+        out[i] = rb | g;
+    }
+}
+
+// First half squeezes the outgoing frame to the centre column, second half
+// stretches the incoming one back out; 16.16 fixed-point column stepping
+void TransitionEngine::fold(uint32_t* out, uint32_t progress) const {
+    bool second_half = progress >= 128;
+    const uint32_t* pixels = (const uint32_t*)(second_half ? to.get_buffer() : from.get_buffer());
+    uint32_t half_progress = second_half ? progress - 128 : 128 - progress;
+    int visible = (width * (int)half_progress) >> 7;
+    int left = (width - visible) / 2;
+    
+    memset(out, 0, (size_t)width * height * sizeof(uint32_t));
+    if (visible <= 0) {
+        return;
+    }
+    
+    uint32_t step = ((uint32_t)width << 16) / visible;
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = out + y * width + left;
+        const uint32_t* source_row = pixels + y * width;
+        uint32_t source_x = 0;
+        for (int x = 0; x < visible; x++) {
+            row[x] = source_row[source_x >> 16];
+            source_x += step;
+        }
+    }
+}
+
+void TransitionEngine::benchmark() {
+    static const TransitionType types[] = {
+        TransitionType::SLIDE, TransitionType::PUSH, TransitionType::CROSSFADE, TransitionType::ROTATE
+    };
+    
+    // Busy test frames - the kernels don't care, but blends of zeros could be optimised away
+    uint32_t* old_pixels = (uint32_t*)from.get_buffer();
+    uint32_t* new_pixels = (uint32_t*)to.get_buffer();
+    for (int i = 0; i < width * height; i++) {
+        old_pixels[i] = (uint32_t)i * 0x010203;
+        new_pixels[i] = ~(uint32_t)i & 0xFFFFFF;
+    }
+    std::vector<uint32_t> out((size_t)width * height);
+    
+    uint32_t frames = TRANSITION_DURATION_MS / TRANSITION_FRAME_PERIOD_MS;
+    TransitionType saved_type = type;
+    for (TransitionType kernel : types) {
+        type = kernel;
+        uint32_t worst = 0;
+        uint32_t total = 0;
+        for (uint32_t frame = 0; frame <= frames; frame++) {
+            uint32_t start_us = time_us_32();
+            compose_at(out.data(), ease(frame * 256 / frames));
+            uint32_t frame_us = time_us_32() - start_us;
+            total += frame_us;
+            if (frame_us > worst) {
+                worst = frame_us;
+            }
+        }
+        printf("Transition benchmark: %-9s worst %4lu us, mean %4lu us per %dx%d frame - %s (budget %u us)\n",
+               get_type_name(kernel), (unsigned long)worst, (unsigned long)(total / (frames + 1)), width, height,
+               worst <= TRANSITION_FRAME_BUDGET_US ? "fits" : "OVER", (unsigned)TRANSITION_FRAME_BUDGET_US);
+    }
+    type = saved_type;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "RenderContext.hpp"
+#include <cstdint>
+
+// Frame period while a transition runs (~60 Hz)
+#define TRANSITION_FRAME_PERIOD_MS 16
+#define TRANSITION_FRAME_BUDGET_US 16666
+
+// Default length of an app or orientation change
+#define TRANSITION_DURATION_MS 400
+
+// Set to 1 to time every transition kernel at boot
+// (cmake -DTRANSITION_BENCHMARK=ON)
+#ifndef TRANSITION_BENCHMARK_AT_BOOT
+#define TRANSITION_BENCHMARK_AT_BOOT 0
+#endif
+
+enum class TransitionType {
+    CUT,        // Instant switch
+    SLIDE,      // Incoming frame slides in over the outgoing one
+    PUSH,       // Incoming frame pushes the outgoing one off
+    CROSSFADE,  // Per-pixel blend from outgoing to incoming
+    ROTATE      // Card turn: outgoing folds to the centre line, incoming unfolds
+};
+
+// Animates between two whole frames
+// The outgoing frame is captured from the panel, the incoming one is drawn
+// offscreen up front; every transition frame is then composed from those
+// two with fixed-point shift, blend and scale kernels - no app drawing at
+// all - so the panel can run at 60 Hz while it lasts.
+class TransitionEngine {
+public:
+    TransitionEngine(int width, int height);
+    
+    // Take what the panel shows now as the outgoing frame
+    void capture_from(const PicoGraphics_PenRGB888& source);
+    
+    // Draw the incoming frame here before start()
+    RenderContext& incoming() { return to.get_context(); }
+    
+    // direction +1: the incoming frame enters at the buffer's right edge
+    // (x = width - 1) and moves left; -1 the other way round
+    void start(TransitionType type, int direction, uint32_t duration_ms, uint32_t now_ms);
+    bool is_running() const { return running; }
+    
+    // Compose the frame for now_ms into destination. Returns false once the
+    // transition is over - destination then holds the incoming frame.
+    bool compose(PicoGraphics_PenRGB888& destination, uint32_t now_ms);
+    
+    // Time every kernel over a full transition and print the cost per frame
+    void benchmark();
+    
+    static const char* get_type_name(TransitionType type);
+
+private:
+    OffscreenTarget from;
+    OffscreenTarget to;
+    int width;
+    int height;
+    
+    TransitionType type;
+    int direction;
+    bool running;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    
+    // Per-transition timing, logged when it ends
+    uint32_t frame_count;
+    uint32_t total_us;
+    uint32_t worst_us;
+    
+    // progress: 0 = all outgoing, 256 = all incoming
+    void compose_at(uint32_t* out, uint32_t progress) const;
+    void shift(uint32_t* out, uint32_t progress, bool push) const;
+    void blend(uint32_t* out, uint32_t progress) const;
+    void fold(uint32_t* out, uint32_t progress) const;
+};
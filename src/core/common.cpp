@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "DisplayList.hpp"
 #include "libraries/bitmap_fonts/font8_data.hpp"
 #include "libraries/bitmap_fonts/font6_data.hpp"
 #include "../utils/network_manager.h"
@@ -44,19 +45,25 @@ Point rotate_vertical(int x, int y) {
 }
 
 // Legacy boolean interface for backward compatibility
-void draw_pixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_pixel(RenderContext& ctx, int x, int y, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
     RotationMode mode = rotate ? RotationMode::HORIZONTAL_UPSIDE_DOWN : RotationMode::HORIZONTAL_UPSIDE_DOWN;
-    draw_pixel_mode(x, y, r, g, b, mode);
+    draw_pixel_mode(ctx, x, y, r, g, b, mode);
 }
 
 // New rotation mode interface
-void draw_pixel_mode(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+void draw_pixel_mode(RenderContext& ctx, int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+    if (DisplayList* list = ctx.get_recorder()) {
+        list->pixel(x, y, r, g, b, rotation);
+        return;
+    }
+    
     // For vertical mode, check against logical 32x64 bounds
     int max_x = (rotation == RotationMode::VERTICAL_CLOCKWISE) ? 32 : DISPLAY_WIDTH;
     int max_y = (rotation == RotationMode::VERTICAL_CLOCKWISE) ? 64 : DISPLAY_HEIGHT;
     
     if (x >= 0 && x < max_x && y >= 0 && y < max_y) {
-        graphics.set_pen(r, g, b);
+        PicoGraphics& target = ctx.target();
+        target.set_pen(r, g, b);
         
         Point final_point;
         if (rotation == RotationMode::HORIZONTAL_UPSIDE_DOWN) {
@@ -67,7 +74,7 @@ void draw_pixel_mode(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode
             final_point = Point(x, y); // No rotation
         }
         
-        graphics.pixel(final_point);
+        target.pixel(final_point);
     }
 }
 
@@ -75,24 +82,31 @@ void draw_pixel_mode(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode
 static bool font_loaded_successfully = false;
 
 // Text drawing using built-in Pimoroni bitmap fonts
-void draw_string(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_string(RenderContext& ctx, int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+    if (DisplayList* list = ctx.get_recorder()) {
+        list->string(x, y, text, r, g, b, rotate);
+        return;
+    }
+    
+    PicoGraphics& target = ctx.target();
+    
     // Green pixel = using working bitmap fonts
-    graphics.set_pen(0, 255, 0);
-    graphics.pixel(Point(0, 31));
+    target.set_pen(0, 255, 0);
+    target.pixel(Point(0, 31));
     
     // Set text color
-    graphics.set_pen(r, g, b);
+    target.set_pen(r, g, b);
     
     // Use font6 - smallest available font for compact display
-    graphics.set_font(&font6);
+    target.set_font(&font6);
     
     // Use built-in bitmap text - simple and reliable
     if (rotate) {
         // For 180-degree rotation, calculate rotated coordinates
         Point rotated = rotate_180(x, y);
-        graphics.text(text, rotated, -1);
+        target.text(text, rotated, -1);
     } else {
-        graphics.text(text, Point(x, y), -1);
+        target.text(text, Point(x, y), -1);
     }
 }
 
@@ -102,21 +116,21 @@ void set_custom_font_status(bool loaded) {
 }
 
 // Legacy function for backward compatibility - now just calls draw_string
-void draw_char(int x, int y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_char(RenderContext& ctx, int x, int y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
     std::string single_char;
     single_char += c;
-    draw_string(x, y, single_char, r, g, b, rotate);
+    draw_string(ctx, x, y, single_char, r, g, b, rotate);
 }
 
 // Draw simple asset logos (8x8 pixel icons)
-void draw_asset_logo(int x, int y, const std::string& ticker, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_asset_logo(RenderContext& ctx, int x, int y, const std::string& ticker, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
     if (ticker == "BTC") {
         // Bitcoin logo (simplified ₿)
         uint8_t bitcoin_logo[8] = {0x1C, 0x22, 0x7E, 0x22, 0x22, 0x7E, 0x22, 0x1C};
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
                 if (bitcoin_logo[row] & (1 << (7 - col))) {
-                    draw_pixel(x + col, y + row, r, g, b, rotate);
+                    draw_pixel(ctx, x + col, y + row, r, g, b, rotate);
                 }
             }
         }
@@ -126,7 +140,7 @@ void draw_asset_logo(int x, int y, const std::string& ticker, uint8_t r, uint8_t
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
                 if (eth_logo[row] & (1 << (7 - col))) {
-                    draw_pixel(x + col, y + row, r, g, b, rotate);
+                    draw_pixel(ctx, x + col, y + row, r, g, b, rotate);
                 }
             }
         }
@@ -136,7 +150,7 @@ void draw_asset_logo(int x, int y, const std::string& ticker, uint8_t r, uint8_t
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
                 if (apple_logo[row] & (1 << (7 - col))) {
-                    draw_pixel(x + col, y + row, r, g, b, rotate);
+                    draw_pixel(ctx, x + col, y + row, r, g, b, rotate);
                 }
             }
         }
@@ -146,22 +160,31 @@ void draw_asset_logo(int x, int y, const std::string& ticker, uint8_t r, uint8_t
         for (int row = 0; row < 8; row++) {
             for (int col = 0; col < 8; col++) {
                 if (tesla_logo[row] & (1 << (7 - col))) {
-                    draw_pixel(x + col, y + row, r, g, b, rotate);
+                    draw_pixel(ctx, x + col, y + row, r, g, b, rotate);
                 }
             }
         }
     } else {
         // Default: Draw ticker as text
-        draw_string(x, y, ticker.substr(0, 3), r, g, b, rotate);
+        draw_string(ctx, x, y, ticker.substr(0, 3), r, g, b, rotate);
     }
 }
 
+// Where PNGDraw puts the decoded lines
+struct PngDrawTarget {
+    RenderContext* ctx;
+    int x;
+    int y;
+    bool rotate;
+};
+
 void PNGDraw(PNGDRAW *pDraw) {
     uint8_t *s = (uint8_t *)pDraw->pPixels;
-    int *coords = (int *)pDraw->pUser;
-    int base_x = coords[0];
-    int base_y = coords[1];
-    bool rotate = coords[2] != 0;
+    PngDrawTarget *draw_target = (PngDrawTarget *)pDraw->pUser;
+    RenderContext& ctx = *draw_target->ctx;
+    int base_x = draw_target->x;
+    int base_y = draw_target->y;
+    bool rotate = draw_target->rotate;
     
     for (int x = 0; x < pDraw->iWidth; x++) {
         uint8_t r, g, b;
@@ -192,11 +215,17 @@ void PNGDraw(PNGDRAW *pDraw) {
         // Skip black pixels (often transparent in indexed images)
         if (r == 0 && g == 0 && b == 0) continue;
         
-        draw_pixel(base_x + x, base_y + pDraw->y, r, g, b, rotate);
+        draw_pixel(ctx, base_x + x, base_y + pDraw->y, r, g, b, rotate);
     }
 }
 
-void draw_weather_icon(int x, int y, const std::string& icon_code, bool rotate) {
+void draw_weather_icon(RenderContext& ctx, int x, int y, const std::string& icon_code, bool rotate) {
+    // Recorded as one command - the PNG is decoded on replay
+    if (DisplayList* list = ctx.get_recorder()) {
+        list->icon(x, y, icon_code, rotate);
+        return;
+    }
+    
     PNG png;
     
     // Select PNG data based on icon code
@@ -259,17 +288,14 @@ void draw_weather_icon(int x, int y, const std::string& icon_code, bool rotate)
         png_len = __50n_png_len;
     }
     
-    // Set up coordinates for callback
-    static int coords[3];
-    coords[0] = x;
-    coords[1] = y;
-    coords[2] = rotate ? 1 : 0;
+    // Set up target and coordinates for callback
+    PngDrawTarget draw_target = { &ctx, x, y, rotate };
     
     if (png_data != nullptr) {
         // Try to decode embedded PNG data
         int rc = png.openRAM((uint8_t *)png_data, png_len, PNGDraw);
         if (rc == PNG_SUCCESS) {
-            png.decode((void *)coords, 0);
+            png.decode((void *)&draw_target, 0);
             png.close();
             return; // Success, exit early
         }
@@ -280,28 +306,28 @@ void draw_weather_icon(int x, int y, const std::string& icon_code, bool rotate)
         // Clear sky - sun icon
         for (int i = 6; i <= 9; i++) {
             for (int j = 6; j <= 9; j++) {
-                draw_pixel(x + i, y + j, 255, 255, 0, rotate);
+                draw_pixel(ctx, x + i, y + j, 255, 255, 0, rotate);
             }
         }
         // Sun rays
-        draw_pixel(x + 7, y + 2, 255, 255, 0, rotate);
-        draw_pixel(x + 7, y + 13, 255, 255, 0, rotate);
-        draw_pixel(x + 2, y + 7, 255, 255, 0, rotate);
-        draw_pixel(x + 13, y + 7, 255, 255, 0, rotate);
+        draw_pixel(ctx, x + 7, y + 2, 255, 255, 0, rotate);
+        draw_pixel(ctx, x + 7, y + 13, 255, 255, 0, rotate);
+        draw_pixel(ctx, x + 2, y + 7, 255, 255, 0, rotate);
+        draw_pixel(ctx, x + 13, y + 7, 255, 255, 0, rotate);
     } else {
         // Default cloud for other weather
         for (int i = 3; i <= 12; i++) {
             for (int j = 5; j <= 10; j++) {
-                draw_pixel(x + i, y + j, 150, 150, 150, rotate);
+                draw_pixel(ctx, x + i, y + j, 150, 150, 150, rotate);
             }
         }
     }
 }
 
-void draw_wifi_status(int x, int y, bool rotate) {
+void draw_wifi_status(RenderContext& ctx, int x, int y, bool rotate) {
     if (!global_network_manager) {
         // No network manager - draw gray pixel
-        draw_pixel(x, y, 128, 128, 128, rotate);
+        draw_pixel(ctx, x, y, 128, 128, 128, rotate);
         return;
     }
     
@@ -310,20 +336,20 @@ void draw_wifi_status(int x, int y, bool rotate) {
     switch (state) {
         case NetworkState::CONNECTED:
             // Green - connected
-            draw_pixel(x, y, 0, 255, 0, rotate);
+            draw_pixel(ctx, x, y, 0, 255, 0, rotate);
             break;
         case NetworkState::CONNECTING:
             // Yellow - connecting
-            draw_pixel(x, y, 255, 255, 0, rotate);
+            draw_pixel(ctx, x, y, 255, 255, 0, rotate);
             break;
         case NetworkState::ERROR:
             // Red - error
-            draw_pixel(x, y, 255, 0, 0, rotate);
+            draw_pixel(ctx, x, y, 255, 0, 0, rotate);
             break;
         case NetworkState::DISCONNECTED:
         default:
             // Blue - disconnected
-            draw_pixel(x, y, 0, 0, 255, rotate);
+            draw_pixel(ctx, x, y, 0, 0, 255, rotate);
             break;
     }
 }
\ No newline at end of file
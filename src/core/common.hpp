@@ -5,6 +5,7 @@
 #include "libraries/interstate75/interstate75.hpp"
 #include "libraries/pico_vector/pico_vector.hpp"
 #include "libraries/pngdec/PNGdec.h"
+#include "RenderContext.hpp"
 #include <string>
 #include <vector>
 
@@ -23,13 +24,6 @@ extern PicoVector picovector;
 class NetworkManager;
 extern NetworkManager* global_network_manager;
 
-// Application types
-enum AppType {
-    APP_WEATHER,
-    APP_STOCKS,
-    APP_CRYPTO
-};
-
 // Input status
 enum class InputStatus {
     NONE,
@@ -68,16 +62,16 @@ enum class RotationMode {
 };
 
 // Drawing functions
-void draw_pixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);  // Legacy boolean interface
-void draw_pixel_mode(int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation = RotationMode::HORIZONTAL_UPSIDE_DOWN);  // New mode interface
-void draw_char(int x, int y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
-void draw_string(int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
-void draw_asset_logo(int x, int y, const std::string& ticker, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
-void draw_weather_icon(int x, int y, const std::string& icon_code, bool rotate = true);
+void draw_pixel(RenderContext& ctx, int x, int y, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);  // Legacy boolean interface
+void draw_pixel_mode(RenderContext& ctx, int x, int y, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation = RotationMode::HORIZONTAL_UPSIDE_DOWN);  // New mode interface
+void draw_char(RenderContext& ctx, int x, int y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
+void draw_string(RenderContext& ctx, int x, int y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
+void draw_asset_logo(RenderContext& ctx, int x, int y, const std::string& ticker, uint8_t r, uint8_t g, uint8_t b, bool rotate = true);
+void draw_weather_icon(RenderContext& ctx, int x, int y, const std::string& icon_code, bool rotate = true);
 void set_custom_font_status(bool loaded);
 
 // WiFi status indicator
-void draw_wifi_status(int x, int y, bool rotate = true);
+void draw_wifi_status(RenderContext& ctx, int x, int y, bool rotate = true);
 
 // Point helpers for rotation
 Point rotate_180(int x, int y);
@@ -1,12 +1,15 @@
 #include "pico/stdlib.h"
-#include "pico/cyw43_arch.h"
-#include "lwip/netif.h"
 #include "hardware/gpio.h"
 #include "common.hpp"
+#include "AppRegistry.hpp"
+#include "Playlist.hpp"
+#include "Transition.hpp"
+#include "DataStore.hpp"
 #include "../apps/WeatherApp.hpp"
 #include "../apps/StockApp.hpp"
 #include "../apps/CryptoApp.hpp"
 #include "../utils/text_renderer.h"
+#include "../utils/network_manager.h"
 
 // GPIO pin definitions
 #define ENCODER_A_PIN 19
@@ -14,20 +17,49 @@
 #define ENCODER_SW_PIN 20
 #define TILT_SWITCH_PIN 26
 
+// Main loop period (10Hz)
+#define FRAME_PERIOD_MS 100
+
+// Playlist slot lengths
+#define WEATHER_SLOT_MS 20000
+#define ASSET_SLOT_MS 6000
+#define ASSETS_PER_APP 5
+
+// WiFi credentials
+#define WIFI_SSID "EddyBsHouse"
+#define WIFI_PASSWORD "swiftwater496"
+
 using namespace pimoroni;
 
 // Global display objects (required by common.cpp)
 Hub75 hub75(64, 32, nullptr, PANEL_GENERIC, false);
 PicoGraphics_PenRGB888 graphics(64, 32, nullptr);
 
+// The panel frame as a draw target
+RenderContext screen(graphics);
+
+// Owns the WiFi radio - apps get connectivity through it
+NetworkManager network_manager;
+
+// Snapshots published by network code for the apps to draw - must be
+// constructed before the apps, which publish their initial data
+DataStore data_store;
+
 // App instances
 WeatherApp weather_app;
 StockApp stock_app;
 CryptoApp crypto_app;
 
+// Encoder order - the first app is shown at boot
+AppRegistry app_registry;
+
+// Unattended rotation: weather, then every stock, then every coin
+Playlist playlist(app_registry);
+
+// Animates app, view and orientation changes
+TransitionEngine transitions(64, 32);
+
 // Global state
-AppType current_app = APP_WEATHER;
-bool wifi_connected = false;
 volatile bool tilt_active = false;
 volatile bool encoder_button_clicked = false;
 
@@ -89,6 +121,16 @@ void poll_controls() {
     }
 }
 
+// Start animating from the frame on the panel (captured by the caller
+// before the change) to the active app's frame after it
+static void begin_transition(TransitionType type, int direction, uint32_t now) {
+    BaseApp* app = app_registry.get_active();
+    app_registry.render(app, transitions.incoming(), app_registry.get_orientation());
+    app->mark_drawn();
+    app_registry.forget_screen();
+    transitions.start(type, direction, TRANSITION_DURATION_MS, now);
+}
+
 // Interrupt callback required function 
 void __isr dma_complete() {
   hub75.dma_complete();
@@ -99,61 +141,38 @@ int main() {
     
     printf("\n=== I75 WEATHER DISPLAY WITH WIFI ===\n");
     
-    // Initialize CYW43 first (EXACT working sequence)
+    // Initialize CYW43 first (EXACT working sequence) and start joining the
+    // network in the background - the apps draw straight away
     printf("Initializing WiFi (CYW43)...\n");
-    if (cyw43_arch_init()) {
+    global_network_manager = &network_manager;
+    if (!network_manager.init_wifi(WIFI_SSID, WIFI_PASSWORD)) {
         printf("ERROR: WiFi init failed!\n");
-        return 1;
     }
-    cyw43_arch_enable_sta_mode();
-    printf("WiFi initialized successfully\n");
     
     // Initialize display after WiFi (EXACT working sequence)
     printf("Initializing display...\n");
     hub75.start(dma_complete);
     
-    // Show connecting screen using proper font and rotation (EXACT working code)
-    graphics.set_pen(0, 0, 0);
-    graphics.clear();
-    draw_text_white(3, 10, "Connecting WiFi...", true);
-    hub75.update(&graphics);
+#if TRANSITION_BENCHMARK_AT_BOOT
+    transitions.benchmark();
+#endif
     
-    // Connect to WiFi (EXACT working sequence)
-    printf("Connecting to EddyBsHouse...\n");
-    int result = cyw43_arch_wifi_connect_timeout_ms("EddyBsHouse", "swiftwater496", CYW43_AUTH_WPA2_AES_PSK, 30000);
+    weather_app.attach_network(network_manager);
     
-    if (result == 0) {
-        printf("WiFi connected successfully!\n");
-        wifi_connected = true;
-        
-        // Get IP address (EXACT working code)
-        while (!cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA)) {
-            sleep_ms(100);
-        }
-        
-        if (netif_default != NULL) {
-            const ip4_addr_t *ip = netif_ip4_addr(netif_default);
-            uint32_t ip_addr = ip4_addr_get_u32(ip);
-            printf("IP Address: %u.%u.%u.%u\n", 
-                   ip_addr & 0xFF, (ip_addr >> 8) & 0xFF, 
-                   (ip_addr >> 16) & 0xFF, (ip_addr >> 24) & 0xFF);
-        }
-        
-        // Show WiFi success briefly using proper font and rotation (EXACT working code)
-        graphics.set_pen(0, 0, 0);
-        graphics.clear();
-        draw_text_white(3, 8, "WiFi Connected!", true);
-        draw_text_white(3, 18, "Starting app...", true);
-        hub75.update(&graphics);
-        sleep_ms(2000);
-        printf("WiFi success screen shown\n");
-        
-    } else {
-        printf("WiFi connection failed with code %d\n", result);
-        wifi_connected = false;
+    app_registry.add(&weather_app);
+    app_registry.add(&stock_app);
+    app_registry.add(&crypto_app);
+    app_registry.switch_to(0);
+    
+    playlist.add(0, 0, WEATHER_SLOT_MS);
+    for (int asset = 0; asset < ASSETS_PER_APP; asset++) {
+        playlist.add(1, asset, ASSET_SLOT_MS);
+    }
+    for (int asset = 0; asset < ASSETS_PER_APP; asset++) {
+        playlist.add(2, asset, ASSET_SLOT_MS);
     }
     
-    // Initialize GPIO for controls after WiFi is connected (polling, no interrupts)
+    // Initialize GPIO for controls (polling, no interrupts)
     printf("Initializing controls (polling mode)...\n");
     gpio_init(ENCODER_A_PIN);
     gpio_init(ENCODER_B_PIN);
@@ -172,6 +191,7 @@ int main() {
     
     // Initialize polling state
     tilt_active = !gpio_get(TILT_SWITCH_PIN);
+    app_registry.set_orientation(tilt_active);
     last_encoder_a = gpio_get(ENCODER_A_PIN);
     last_encoder_b = gpio_get(ENCODER_B_PIN);
     last_button_state = gpio_get(ENCODER_SW_PIN);
@@ -179,69 +199,78 @@ int main() {
     printf("Starting main app loop...\n");
     
     // Main loop with controls
+    absolute_time_t next_frame = make_timeout_time_ms(FRAME_PERIOD_MS);
+    uint32_t last_frame_ms = to_ms_since_boot(get_absolute_time());
     while (true) {
-        // Poll WiFi
-        if (wifi_connected) {
-            cyw43_arch_poll();
-        }
+        // Poll WiFi, follow the connection and run every HTTP client's requests
+        network_manager.process();
         
         // Poll all controls (no interrupts)
         poll_controls();
         
-        // Handle encoder app switching
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        
+        // Handle encoder app switching - one app per detent batch. The panel
+        // is mounted upside down, so the next app comes in at buffer x = 0.
         if (encoder_pos != last_encoder_pos) {
             int delta = encoder_pos - last_encoder_pos;
-            
-            if (delta > 0) {
-                current_app = (AppType)((current_app + 1) % 3);
-            } else if (delta < 0) {
-                current_app = (AppType)((current_app + 2) % 3);
-            }
-            
+            transitions.capture_from(graphics);
+            app_registry.step(delta > 0 ? 1 : -1);
+            begin_transition(TransitionType::PUSH, delta > 0 ? -1 : 1, now);
             last_encoder_pos = encoder_pos;
-            printf("Switched to app: %d\n", current_app);
+            playlist.on_user_input(now);
         }
         
         // Handle button press
         if (encoder_button_clicked) {
             encoder_button_clicked = false;
-            
-            switch (current_app) {
-                case APP_WEATHER:
-                    weather_app.handle_button_press(tilt_active);
-                    break;
-                case APP_STOCKS:
-                    stock_app.handle_button_press(tilt_active);
-                    break;
-                case APP_CRYPTO:
-                    crypto_app.handle_button_press(tilt_active);
-                    break;
-            }
-            printf("Button pressed for app: %d\n", current_app);
+            transitions.capture_from(graphics);
+            app_registry.handle_button_press(tilt_active);
+            begin_transition(TransitionType::CROSSFADE, 1, now);
+            playlist.on_user_input(now);
         }
         
-        // Clear screen and draw current app
-        graphics.set_pen(0, 0, 0);
-        graphics.clear();
-        
         // Draw current app based on tilt (true = horizontal, false = vertical)
-        switch (current_app) {
-            case APP_WEATHER:
-                weather_app.draw(tilt_active);
-                break;
-            case APP_STOCKS:
-                stock_app.draw(tilt_active);
-                break;
-            case APP_CRYPTO:
-                crypto_app.draw(tilt_active);
-                break;
+        if (tilt_active != app_registry.get_orientation()) {
+            transitions.capture_from(graphics);
+            app_registry.set_orientation(tilt_active);
+            begin_transition(TransitionType::ROTATE, 1, now);
         }
         
-        // Update display
-        hub75.update(&graphics);
+        // Update phase: background service ticks for every app, UI work for the active one
+        app_registry.update(now - last_frame_ms);
+        last_frame_ms = now;
+        
+        bool frame_ready;
+        if (transitions.is_running()) {
+            // Transition frames replace the draw phase; the last one leaves
+            // the new app's frame on the panel
+            transitions.compose(graphics, now);
+            frame_ready = true;
+        } else {
+            // Draw phase: only when the active app changed something
+            frame_ready = app_registry.draw(screen);
+            
+            // Rotate the playlist; idle frames go into preparing the next slot
+            if (playlist.update(now, !frame_ready, screen)) {
+                frame_ready = true;
+            }
+        }
+        if (frame_ready) {
+            hub75.update(&graphics);
+        } else {
+            // Nothing moving on the panel - the flash erase stall hides best here
+            network_manager.save_association();
+        }
         
-        // Update at 10Hz
-        sleep_ms(100);
+        // Update at 10Hz, or 60Hz while animating - sleep whatever the frame did not use
+        uint32_t period_ms = transitions.is_running() ? TRANSITION_FRAME_PERIOD_MS : FRAME_PERIOD_MS;
+        sleep_until(next_frame);
+        next_frame = delayed_by_ms(next_frame, period_ms);
+        if (absolute_time_diff_us(next_frame, get_absolute_time()) > 0) {
+            // Fell behind - don't try to catch up with a burst of frames
+            next_frame = make_timeout_time_ms(period_ms);
+        }
     }
     
     return 0;
@@ -0,0 +1,340 @@
+#include "altcp_transport.h"
+
+// Fix header conflicts - undef problematic macros before including lwIP
+#ifdef local
+#undef local
+#endif
+
+#include "lwip/altcp.h"
+#include "lwip/altcp_tls.h"
+#include "lwip/pbuf.h"
+#include "mbedtls/ssl.h"
+#include "lwip_mbedtls_compat.h"
+#include "pbuf_view.h"
+#include "tls_memory.h"
+#include <cstdio>
+#include <algorithm>
+
+static uint32_t now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// ---------------------------------------------------------------------------
+// AltcpConnection
+// ---------------------------------------------------------------------------
+
+AltcpConnection::AltcpConnection(AltcpTransport* transport, const std::string& host, uint16_t port)
+    : connect_started_ms(0)
+    , dns_ms(0)
+    , session_offered(false)
+    , transport(transport)
+    , listener(nullptr)
+    , host(host)
+    , port(port)
+    , pcb(nullptr)
+    , state(State::IDLE)
+    , dns_lookup(0)
+    , depth(0)
+    , aborted(false) {
+}
+
+AltcpConnection::~AltcpConnection() {
+}
+
+signed char AltcpConnection::leave() {
+    err_t result = aborted ? ERR_ABRT : ERR_OK;
+    if (--depth == 0) {
+        aborted = false;
+        if (state == State::CLOSED) {
+            delete this;
+        }
+    }
+    return result;
+}
+
+void AltcpConnection::connect(TransportListener* listener) {
+    this->listener = listener;
+    state = State::RESOLVING;
+    connect_started_ms = now_ms();
+    
+    enter();
+    
+    // A cached answer calls back straight away
+    uint32_t lookup = transport->dns_cache.resolve(host, [this](const ip_addr_t* addr, uint32_t dns_ms) {
+        dns_lookup = 0;
+        on_resolved(addr, dns_ms);
+    });
+    if (lookup != 0 && state == State::RESOLVING) {
+        dns_lookup = lookup;
+    }
+    
+    leave();
+}
+
+void AltcpConnection::on_resolved(const ip_addr_t* addr, uint32_t dns_ms) {
+    enter();
+    this->dns_ms = dns_ms;
+    
+    if (addr == nullptr) {
+        fail(HttpError::DNS_FAILED);
+        leave();
+        return;
+    }
+    
+    connect_started_ms = now_ms();
+    pcb = transport->new_pcb(this);
+    if (pcb == nullptr) {
+        fail(HttpError::OUT_OF_MEMORY);
+        leave();
+        return;
+    }
+    
+    state = State::CONNECTING;
+    altcp_arg(pcb, this);
+    altcp_err(pcb, err_callback);
+    altcp_recv(pcb, recv_callback);
+    
+    err_t err = altcp_connect(pcb, addr, port, connected_callback);
+    if (err != ERR_OK) {
+        printf("AltcpConnection: Connect to %s failed: %d\n", host.c_str(), err);
+        fail(HttpError::CONNECT_FAILED);
+    }
+    leave();
+}
+
+void AltcpConnection::detach_pcb() {
+    altcp_arg(pcb, nullptr);
+    altcp_recv(pcb, nullptr);
+    altcp_err(pcb, nullptr);
+}
+
+void AltcpConnection::fail(HttpError error) {
+    if (state == State::CLOSED) {
+        return;
+    }
+    if (state != State::READY) {
+        transport->on_connect_failed(this);
+    }
+    
+    TransportListener* notify = listener;
+    close(true);
+    if (notify) {
+        notify->on_closed(this, error);
+    }
+}
+
+HttpError AltcpConnection::write(std::string_view data) {
+    if (state != State::READY || pcb == nullptr) {
+        return HttpError::CONNECTION_LOST;
+    }
+    
+    err_t err = altcp_write(pcb, data.data(), data.length(), TCP_WRITE_FLAG_COPY);
+    if (err != ERR_OK) {
+        printf("AltcpConnection: Write to %s failed: %d\n", host.c_str(), err);
+        return err == ERR_MEM ? HttpError::OUT_OF_MEMORY : HttpError::CONNECTION_LOST;
+    }
+    
+    altcp_output(pcb);
+    return HttpError::NONE;
+}
+
+void AltcpConnection::close(bool abort) {
+    if (state == State::CLOSED) {
+        return;
+    }
+    state = State::CLOSED;
+    listener = nullptr;
+    
+    if (dns_lookup != 0) {
+        transport->dns_cache.cancel(dns_lookup);
+        dns_lookup = 0;
+    }
+    
+    if (pcb) {
+        struct altcp_pcb* closing = pcb;
+        detach_pcb();
+        pcb = nullptr;
+        
+        if (abort || altcp_close(closing) != ERR_OK) {
+            altcp_abort(closing);
+            aborted = true;
+        }
+    }
+    
+    if (depth == 0) {
+        delete this;
+    }
+}
+
+err_t AltcpConnection::connected_callback(void* arg, struct altcp_pcb* pcb, err_t err) {
+    (void)pcb;
+    AltcpConnection* connection = (AltcpConnection*)arg;
+    connection->enter();
+    
+    if (err != ERR_OK) {
+        printf("AltcpConnection: Connection to %s failed: %d\n", connection->host.c_str(), err);
+        connection->fail(HttpError::CONNECT_FAILED);
+    } else {
+        connection->state = State::READY;
+        connection->transport->on_established(connection);
+        if (connection->listener) {
+            connection->listener->on_connected(connection);
+        }
+    }
+    
+    return connection->leave();
+}
+
+err_t AltcpConnection::recv_callback(void* arg, struct altcp_pcb* pcb, struct pbuf* p, err_t err) {
+    (void)err;
+    AltcpConnection* connection = (AltcpConnection*)arg;
+    connection->enter();
+    
+    if (p == nullptr) {
+        // Peer closed its side
+        TransportListener* notify = connection->listener;
+        connection->close(false);
+        if (notify) {
+            notify->on_closed(connection, HttpError::NONE);
+        }
+        return connection->leave();
+    }
+    
+    // Hand over every segment in place until the listener closes us
+    for_each_pbuf_segment(p, [connection](std::string_view segment) {
+        if (connection->listener == nullptr) {
+            return false;
+        }
+        connection->listener->on_data(connection, segment);
+        return connection->state == State::READY;
+    });
+    
+    // The listener is done with the data - release it and reopen the window
+    if (connection->pcb == pcb) {
+        altcp_recved(pcb, p->tot_len);
+    }
+    pbuf_free(p);
+    
+    return connection->leave();
+}
+
+void AltcpConnection::err_callback(void* arg, err_t err) {
+    AltcpConnection* connection = (AltcpConnection*)arg;
+    if (connection == nullptr) {
+        return;
+    }
+    
+    // lwIP has already freed the pcb
+    connection->pcb = nullptr;
+    printf("AltcpConnection: Connection to %s error: %d\n", connection->host.c_str(), err);
+    
+    connection->enter();
+    connection->fail(connection->state == State::READY ? HttpError::CONNECTION_LOST : HttpError::CONNECT_FAILED);
+    connection->leave();
+}
+
+// ---------------------------------------------------------------------------
+// Transports
+// ---------------------------------------------------------------------------
+
+AltcpTransport::AltcpTransport(DnsCache& dns_cache)
+    : dns_cache(dns_cache) {
+}
+
+TransportConnection* AltcpTransport::create(const std::string& host, uint16_t port) {
+    return new AltcpConnection(this, host, port);
+}
+
+struct altcp_pcb* TcpTransport::new_pcb(AltcpConnection* connection) {
+    struct altcp_pcb* pcb = altcp_new(nullptr);
+    if (pcb == nullptr) {
+        printf("TcpTransport: Failed to create TCP PCB for %s\n", connection->get_host().c_str());
+    }
+    return pcb;
+}
+
+void TcpTransport::on_established(AltcpConnection* connection) {
+    printf("TcpTransport: Connected to %s in %lu ms (DNS %lu ms)\n", connection->get_host().c_str(),
+           (unsigned long)(now_ms() - connection->connect_started_ms), (unsigned long)connection->dns_ms);
+}
+
+TlsTransport::TlsTransport(DnsCache& dns_cache)
+    : AltcpTransport(dns_cache)
+    , tls_config(nullptr)
+    , handshake_stats{0, 0, 0, UINT32_MAX, 0} {
+    // mbedTLS must allocate from its own arena before anything TLS exists
+    tls_memory_init();
+    
+    tls_config = altcp_tls_create_config_client(NULL, 0);
+    
+    // Request 4KB records so the receive buffer can shrink after the
+    // handshake. Set once here - every connection shares this config.
+    mbedtls_ssl_config* ssl_config = altcp_tls_config_get_ssl_config(tls_config);
+    if (ssl_config) {
+        mbedtls_ssl_conf_max_frag_len(ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_4096);
+    }
+    
+    // Sessions from before the last reboot can still be resumed
+    session_cache.load_from_flash();
+}
+
+TlsTransport::~TlsTransport() {
+    if (tls_config) {
+        altcp_tls_free_config(tls_config);
+        tls_config = nullptr;
+    }
+}
+
+void TlsTransport::process(uint32_t now_ms) {
+    session_cache.process(now_ms);
+}
+
+struct altcp_pcb* TlsTransport::new_pcb(AltcpConnection* connection) {
+    struct altcp_pcb* pcb = altcp_tls_new(tls_config, IPADDR_TYPE_ANY);
+    if (pcb == nullptr) {
+        printf("TlsTransport: Failed to create TLS PCB\n");
+        return nullptr;
+    }
+    
+    // Set hostname for SNI
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*)altcp_tls_context(pcb);
+    mbedtls_ssl_set_hostname(ssl, connection->get_host().c_str());
+    
+    // Offer the last session with this host for an abbreviated handshake
+    connection->session_offered = session_cache.apply(connection->get_host(), ssl);
+    return pcb;
+}
+
+void TlsTransport::on_established(AltcpConnection* connection) {
+    // Connect + handshake time per negotiated suite
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*)altcp_tls_context(connection->get_pcb());
+    uint32_t handshake_ms = now_ms() - connection->connect_started_ms;
+    HandshakeStats& stats = handshake_stats;
+    stats.count++;
+    stats.total_ms += handshake_ms;
+    stats.min_ms = std::min(stats.min_ms, handshake_ms);
+    stats.max_ms = std::max(stats.max_ms, handshake_ms);
+    if (connection->session_offered) {
+        stats.resumption_offered++;
+    }
+    
+    printf("HTTPS connected to %s in %lu ms after %lu ms DNS (%s, %s) - avg %lu ms over %lu\n",
+           connection->get_host().c_str(), (unsigned long)handshake_ms, (unsigned long)connection->dns_ms,
+           mbedtls_ssl_get_ciphersuite(ssl),
+           connection->session_offered ? "resumption offered" : "full handshake",
+           (unsigned long)(stats.total_ms / stats.count), (unsigned long)stats.count);
+    
+    TlsMemoryStats memory = tls_memory_stats();
+    printf("TLS arena: %u bytes in use, peak %u of %u, largest free %u\n", (unsigned)memory.current_bytes,
+           (unsigned)memory.peak_bytes, (unsigned)memory.arena_size, (unsigned)memory.largest_free);
+    
+    // Keep the (possibly new) session and ticket for the next connection
+    session_cache.store(connection->get_host(), ssl);
+}
+
+void TlsTransport::on_connect_failed(AltcpConnection* connection) {
+    if (connection->session_offered) {
+        // The server may have choked on a stale session - start clean next time
+        session_cache.forget(connection->get_host());
+    }
+}
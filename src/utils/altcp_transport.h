@@ -0,0 +1,131 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "http_transport.h"
+#include "dns_cache.h"
+#include "tls_session_cache.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Forward declarations to avoid header conflicts
+struct altcp_pcb;
+struct altcp_tls_config;
+struct pbuf;
+
+class AltcpTransport;
+
+// One connection over lwIP's altcp API, plain TCP or TLS
+class AltcpConnection : public TransportConnection {
+public:
+    AltcpConnection(AltcpTransport* transport, const std::string& host, uint16_t port);
+    
+    void connect(TransportListener* listener) override;
+    HttpError write(std::string_view data) override;
+    void close(bool abort) override;
+    
+    const std::string& get_host() const { return host; }
+    struct altcp_pcb* get_pcb() const { return pcb; }
+    
+    // Set up by the transport around the connect
+    uint32_t connect_started_ms;
+    uint32_t dns_ms;
+    bool session_offered;        // TLS: cached session offered for resumption
+    
+private:
+    enum class State : uint8_t {
+        IDLE,
+        RESOLVING,
+        CONNECTING,
+        READY,
+        CLOSED
+    };
+    
+    AltcpTransport* transport;
+    TransportListener* listener;
+    std::string host;
+    uint16_t port;
+    struct altcp_pcb* pcb;
+    State state;
+    uint32_t dns_lookup;         // Pending DnsCache lookup (0 = none)
+    int depth;                   // Nesting of events being delivered
+    bool aborted;                // pcb aborted during the current event
+    
+    ~AltcpConnection();
+    
+    // Events run between enter() and leave(); a connection closed meanwhile
+    // is freed by the outermost leave(), which returns the lwIP result
+    void enter() { depth++; }
+    signed char leave();
+    
+    void on_resolved(const ip_addr_t* addr, uint32_t dns_ms);
+    void fail(HttpError error);
+    void detach_pcb();
+    
+    static signed char connected_callback(void* arg, struct altcp_pcb* pcb, signed char err);
+    static signed char recv_callback(void* arg, struct altcp_pcb* pcb, struct pbuf* p, signed char err);
+    static void err_callback(void* arg, signed char err);
+};
+
+// Shared plumbing of the lwIP transports
+class AltcpTransport : public HttpTransport {
+public:
+    explicit AltcpTransport(DnsCache& dns_cache);
+    
+    TransportConnection* create(const std::string& host, uint16_t port) override;
+    
+protected:
+    friend class AltcpConnection;
+    
+    DnsCache& dns_cache;
+    
+    // New pcb for a resolved connection (nullptr if out of memory)
+    virtual struct altcp_pcb* new_pcb(AltcpConnection* connection) = 0;
+    
+    // The stream is up / setting it up failed
+    virtual void on_established(AltcpConnection* connection) { (void)connection; }
+    virtual void on_connect_failed(AltcpConnection* connection) { (void)connection; }
+};
+
+// Plain HTTP over lwIP TCP
+class TcpTransport : public AltcpTransport {
+public:
+    explicit TcpTransport(DnsCache& dns_cache) : AltcpTransport(dns_cache) {}
+    
+    uint16_t default_port() const override { return 80; }
+    
+protected:
+    struct altcp_pcb* new_pcb(AltcpConnection* connection) override;
+    void on_established(AltcpConnection* connection) override;
+};
+
+// HTTPS over lwIP altcp TLS (mbedTLS), with session resumption
+class TlsTransport : public AltcpTransport {
+public:
+    // Handshake metrics, for comparing TLS profiles on the device
+    struct HandshakeStats {
+        uint32_t count;
+        uint32_t resumption_offered;
+        uint32_t total_ms;
+        uint32_t min_ms;
+        uint32_t max_ms;
+    };
+    
+    explicit TlsTransport(DnsCache& dns_cache);
+    ~TlsTransport();
+    
+    uint16_t default_port() const override { return 443; }
+    void process(uint32_t now_ms) override;
+    
+    const HandshakeStats& get_handshake_stats() const { return handshake_stats; }
+    
+protected:
+    struct altcp_pcb* new_pcb(AltcpConnection* connection) override;
+    void on_established(AltcpConnection* connection) override;
+    void on_connect_failed(AltcpConnection* connection) override;
+    
+private:
+    struct altcp_tls_config* tls_config;
+    TlsSessionCache session_cache;
+    HandshakeStats handshake_stats;
+};
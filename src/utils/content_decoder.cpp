@@ -0,0 +1,220 @@
+#include "content_decoder.h"
+#include "zlib.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+// The inflater must take a window size and wrapper choice (gzip is +16)
+#if !defined(inflateInit2) || !defined(MAX_WBITS)
+#error "ContentDecoder needs a zlib with inflateInit2 (check the zlib bundled with PNGdec)"
+#endif
+
+// Everything zlib allocates for the running decoder: a bump allocator over
+// one static block, emptied when that decoder goes away
+alignas(8) static uint8_t arena[CONTENT_DECODER_ARENA_SIZE];
+static size_t arena_used = 0;
+static bool arena_busy = false;
+static bool slot_claimed = false;
+
+static void* zlib_alloc(void* opaque, unsigned items, unsigned size) {
+    (void)opaque;
+    size_t bytes = ((size_t)items * size + 7) & ~(size_t)7;
+    if (bytes > sizeof(arena) - arena_used) {
+        printf("ContentDecoder: Arena exhausted (%u of %u bytes used, %u more wanted)\n",
+               (unsigned)arena_used, (unsigned)sizeof(arena), (unsigned)bytes);
+        return Z_NULL;
+    }
+    void* block = arena + arena_used;
+    arena_used += bytes;
+    memset(block, 0, bytes);
+    return block;
+}
+
+static void zlib_free(void* opaque, void* address) {
+    // The whole arena is emptied at once
+    (void)opaque;
+    (void)address;
+}
+
+// A one-byte gzip member ("ok"), inflated once to prove gzip support
+static const uint8_t gzip_probe[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xcb, 0xcf,
+    0x06, 0x00, 0x47, 0xdd, 0xdc, 0x79, 0x02, 0x00, 0x00, 0x00
+};
+
+static bool gzip_supported() {
+    static int supported = -1;
+    if (supported < 0) {
+        std::string decoded;
+        {
+            ContentDecoder probe(ContentDecoder::Encoding::GZIP);
+            bool ok = probe.feed(std::string_view((const char*)gzip_probe, sizeof(gzip_probe)),
+                                 [&decoded](std::string_view chunk) { decoded.append(chunk); });
+            supported = ok && probe.is_finished() && decoded == "ok";
+        }
+        if (!supported) {
+            printf("ContentDecoder: zlib cannot inflate gzip - responses will not be compressed\n");
+        }
+    }
+    return supported == 1;
+}
+
+bool ContentDecoder::claim_slot() {
+    if (slot_claimed || arena_busy || !gzip_supported()) {
+        return false;
+    }
+    slot_claimed = true;
+    return true;
+}
+
+void ContentDecoder::release_slot() {
+    slot_claimed = false;
+}
+
+ContentDecoder::Encoding ContentDecoder::parse_encoding(const std::string& value) {
+    std::string lower;
+    for (char c : value) {
+        if (c != ' ' && c != '\t') {
+            lower += (char)std::tolower((unsigned char)c);
+        }
+    }
+    
+    if (lower.empty() || lower == "identity") {
+        return Encoding::IDENTITY;
+    }
+    if (lower == "gzip" || lower == "x-gzip") {
+        return Encoding::GZIP;
+    }
+    if (lower == "deflate") {
+        return Encoding::DEFLATE;
+    }
+    return Encoding::UNSUPPORTED;  // Stacked codings, br, ...
+}
+
+ContentDecoder::ContentDecoder(Encoding encoding)
+    : encoding(encoding)
+    , stream(nullptr)
+    , started(false)
+    , owns_arena(false)
+    , finished(false)
+    , failed(encoding == Encoding::UNSUPPORTED)
+    , header{0, 0}
+    , header_len(0)
+    , encoded_bytes(0)
+    , decoded_bytes(0) {
+}
+
+ContentDecoder::~ContentDecoder() {
+    if (stream) {
+        if (started) {
+            inflateEnd(stream);
+        }
+        delete stream;
+    }
+    if (owns_arena) {
+        arena_used = 0;
+        arena_busy = false;
+    }
+}
+
+bool ContentDecoder::start(bool raw) {
+    if (arena_busy) {
+        printf("ContentDecoder: Another body is decoding\n");
+        return false;
+    }
+    arena_busy = true;
+    owns_arena = true;
+    arena_used = 0;
+    
+    stream = new z_stream();
+    stream->zalloc = zlib_alloc;
+    stream->zfree = zlib_free;
+    stream->opaque = nullptr;
+    
+    // 15 = full 32 KB window, which is what servers compress with.
+    // +16 expects a gzip wrapper, negative means no wrapper at all.
+    int window_bits = raw ? -15 : (encoding == Encoding::GZIP ? 15 + 16 : 15);
+    if (inflateInit2(stream, window_bits) != Z_OK) {
+        printf("ContentDecoder: Could not start inflater\n");
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+bool ContentDecoder::inflate_input(const uint8_t* data, size_t len, const OutputCallback& output) {
+    uint8_t out[CONTENT_DECODER_OUTPUT_SIZE];
+    
+    stream->next_in = (Bytef*)data;
+    stream->avail_in = (uInt)len;
+    
+    // Run until the input is used up and no output is held back
+    do {
+        stream->next_out = out;
+        stream->avail_out = sizeof(out);
+        
+        int result = inflate(stream, Z_NO_FLUSH);
+        size_t produced = sizeof(out) - stream->avail_out;
+        if (produced > 0) {
+            decoded_bytes += produced;
+            if (output) {
+                output(std::string_view((const char*)out, produced));
+            }
+        }
+        
+        if (result == Z_STREAM_END) {
+            finished = true;
+            return true;  // Anything after the stream is ignored
+        }
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            printf("ContentDecoder: Inflate failed (%d)\n", result);
+            return false;
+        }
+        if (result == Z_BUF_ERROR && produced == 0) {
+            break;  // Needs more input
+        }
+    } while (stream->avail_in > 0 || stream->avail_out == 0);
+    
+    return true;
+}
+
+bool ContentDecoder::feed(std::string_view chunk, const OutputCallback& output) {
+    if (failed) {
+        return false;
+    }
+    if (finished) {
+        return true;
+    }
+    encoded_bytes += chunk.size();
+    
+    const uint8_t* data = (const uint8_t*)chunk.data();
+    size_t len = chunk.size();
+    
+    if (!started) {
+        if (encoding == Encoding::DEFLATE) {
+            // "deflate" should be zlib-wrapped, but some servers send raw
+            // deflate. A zlib header is CM=8 with a check value divisible by 31.
+            while (header_len < 2 && len > 0) {
+                header[header_len++] = *data++;
+                len--;
+            }
+            if (header_len < 2) {
+                return true;
+            }
+            bool zlib = (header[0] & 0x0F) == 8 && ((header[0] << 8) | header[1]) % 31 == 0;
+            if (!start(!zlib) || !inflate_input(header, 2, output)) {
+                failed = true;
+                return false;
+            }
+        } else if (!start(false)) {
+            failed = true;
+            return false;
+        }
+    }
+    
+    if (len > 0 && !finished && !inflate_input(data, len, output)) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Request header advertising the codings ContentDecoder understands
+#define HTTP_ACCEPT_ENCODING_HEADER "Accept-Encoding: gzip, deflate\r\n"
+
+// Inflated bytes handed on per callback
+#define CONTENT_DECODER_OUTPUT_SIZE 512
+
+// Static arena for the one body that decodes at a time: zlib's 32 KB history
+// window plus its ~7 KB inflate state. Nothing comes from the heap, so
+// compressed responses cannot fragment it.
+#define CONTENT_DECODER_ARENA_SIZE (40 * 1024)
+
+typedef struct z_stream_s z_stream;
+
+// Streaming decoder for gzip/deflate Content-Encoding
+// Uses the zlib inflater bundled with PNGdec (system zlib in host builds).
+// Compressed chunks go in as they arrive; decoded data comes out through the
+// callback in pieces of at most CONTENT_DECODER_OUTPUT_SIZE bytes. Only one
+// decoder can run at a time - see claim_slot().
+class ContentDecoder {
+public:
+    enum class Encoding : uint8_t {
+        IDENTITY,
+        GZIP,
+        DEFLATE,    // zlib-wrapped, or raw deflate from non-conforming servers
+        UNSUPPORTED
+    };
+    
+    using OutputCallback = std::function<void(std::string_view chunk)>;
+    
+    // Map a Content-Encoding header value
+    static Encoding parse_encoding(const std::string& value);
+    
+    // The single decoding slot. A request claims it before it advertises
+    // HTTP_ACCEPT_ENCODING_HEADER and releases it once its response is done;
+    // when it is taken, requests go out without asking for compression. The
+    // first claim checks that the zlib in the build really inflates gzip -
+    // if it does not, compression is never asked for.
+    static bool claim_slot();
+    static void release_slot();
+    
+    explicit ContentDecoder(Encoding encoding);
+    ~ContentDecoder();
+    
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+    
+    // Decode a compressed chunk. Returns false on corrupt data or when the
+    // inflater cannot get memory.
+    bool feed(std::string_view chunk, const OutputCallback& output);
+    
+    // True once the compressed stream has ended cleanly
+    bool is_finished() const { return finished; }
+    
+    size_t get_encoded_bytes() const { return encoded_bytes; }
+    size_t get_decoded_bytes() const { return decoded_bytes; }
+    
+private:
+    Encoding encoding;
+    z_stream* stream;
+    bool started;
+    bool owns_arena;
+    bool finished;
+    bool failed;
+    uint8_t header[2];      // First bytes of a deflate body, to tell zlib from raw
+    size_t header_len;
+    size_t encoded_bytes;
+    size_t decoded_bytes;
+    
+    bool start(bool raw);
+    bool inflate_input(const uint8_t* data, size_t len, const OutputCallback& output);
+};
@@ -0,0 +1,282 @@
+#include "dns_cache.h"
+
+// Fix header conflicts - undef problematic macros before including lwIP
+#ifdef local
+#undef local
+#endif
+
+#include "lwip/dns.h"
+#include "lwip/ip_addr.h"
+#include <cstdio>
+#include <algorithm>
+
+static uint32_t now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Wrap-safe "now is before t"
+static bool before(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) < 0;
+}
+
+DnsCache::DnsCache()
+    : next_id(1)
+    , stats{} {
+}
+
+DnsCache::~DnsCache() {
+    // lwIP may still call back - let those lookups free themselves
+    for (Lookup* lookup : lookups) {
+        lookup->cache = nullptr;
+    }
+    lookups.clear();
+    
+    for (Entry* entry : entries) {
+        delete entry;
+    }
+    entries.clear();
+}
+
+DnsCache::Entry* DnsCache::find(const std::string& host) {
+    for (Entry* entry : entries) {
+        if (entry->host == host) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+DnsCache::Entry* DnsCache::create(const std::string& host) {
+    if (entries.size() >= DNS_CACHE_SIZE) {
+        // Evict the least recently used entry nobody is waiting on
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            Entry* entry = *it;
+            if (entry->lookup_pending || !entry->waiters.empty()) {
+                continue;
+            }
+            if (victim == entries.end() || before(entry->last_used_ms, (*victim)->last_used_ms)) {
+                victim = it;
+            }
+        }
+        if (victim != entries.end()) {
+            delete *victim;
+            entries.erase(victim);
+        }
+    }
+    
+    Entry* entry = new Entry();
+    entry->host = host;
+    entry->addr = 0;
+    entry->resolved = false;
+    entry->expires_ms = 0;
+    entry->last_used_ms = now_ms();
+    entry->lookup_pending = false;
+    entry->lookup_started_ms = 0;
+    entry->retry_after_ms = 0;
+    entries.push_back(entry);
+    return entry;
+}
+
+bool DnsCache::may_refresh(const Entry* entry, uint32_t now) const {
+    return !entry->lookup_pending && (entry->retry_after_ms == 0 || !before(now, entry->retry_after_ms));
+}
+
+bool DnsCache::is_waiting(uint32_t lookup_id) const {
+    for (const Entry* entry : entries) {
+        for (const Waiter& waiter : entry->waiters) {
+            if (waiter.id == lookup_id) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t DnsCache::resolve(const std::string& host, ResolveCallback callback) {
+    uint32_t now = now_ms();
+    Entry* entry = find(host);
+    
+    if (entry && entry->expires_ms != 0) {
+        bool fresh = before(now, entry->expires_ms);
+        bool usable = entry->resolved && (fresh || before(now, entry->expires_ms + DNS_CACHE_STALE_MS));
+        
+        if (usable) {
+            entry->last_used_ms = now;
+            if (fresh) {
+                stats.hits++;
+            } else {
+                // Serve the old answer now, refresh behind it
+                stats.stale_hits++;
+                if (may_refresh(entry, now)) {
+                    start_lookup(entry);
+                    entry = find(host);
+                }
+            }
+            
+            ip_addr_t addr;
+            ip_addr_set_ip4_u32(&addr, entry ? entry->addr : 0);
+            callback(entry ? &addr : nullptr, 0);
+            return 0;
+        }
+        
+        if (!entry->resolved && fresh) {
+            stats.negative_hits++;
+            callback(nullptr, 0);
+            return 0;
+        }
+    }
+    
+    stats.misses++;
+    if (entry == nullptr) {
+        entry = create(host);
+    }
+    entry->last_used_ms = now;
+    
+    uint32_t id = next_id++;
+    if (next_id == 0) {
+        next_id = 1;
+    }
+    entry->waiters.push_back({id, callback, now});
+    
+    if (!entry->lookup_pending) {
+        start_lookup(entry);
+    }
+    
+    // lwIP may have answered from its own table already
+    return is_waiting(id) ? id : 0;
+}
+
+void DnsCache::cancel(uint32_t lookup_id) {
+    for (Entry* entry : entries) {
+        auto& waiters = entry->waiters;
+        for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+            if (it->id == lookup_id) {
+                waiters.erase(it);
+                return;
+            }
+        }
+    }
+}
+
+void DnsCache::prefetch(const std::string& host) {
+    uint32_t now = now_ms();
+    Entry* entry = find(host);
+    if (entry == nullptr) {
+        entry = create(host);
+    }
+    entry->last_used_ms = now;
+    
+    bool expiring = entry->expires_ms == 0 || !before(now, entry->expires_ms - DNS_CACHE_PREFETCH_MS);
+    if (may_refresh(entry, now) && expiring) {
+        stats.prefetches++;
+        start_lookup(entry);
+    }
+}
+
+void DnsCache::process(uint32_t now_ms) {
+    // Iterate over a copy - a lookup answered from lwIP's table completes inline
+    std::vector<Entry*> snapshot = entries;
+    for (Entry* entry : snapshot) {
+        if (std::find(entries.begin(), entries.end(), entry) == entries.end()) {
+            continue;
+        }
+        if (!entry->resolved || entry->expires_ms == 0 || !may_refresh(entry, now_ms)) {
+            continue;
+        }
+        
+        bool hot = now_ms - entry->last_used_ms < DNS_CACHE_HOT_MS;
+        bool expiring = !before(now_ms, entry->expires_ms - DNS_CACHE_PREFETCH_MS);
+        if (hot && expiring) {
+            stats.prefetches++;
+            start_lookup(entry);
+        }
+    }
+}
+
+void DnsCache::start_lookup(Entry* entry) {
+    entry->lookup_pending = true;
+    entry->lookup_started_ms = now_ms();
+    stats.lookups++;
+    
+    Lookup* lookup = new Lookup{this, entry->host};
+    ip_addr_t addr;
+    err_t err = dns_gethostbyname(entry->host.c_str(), &addr, dns_callback, lookup);
+    
+    if (err == ERR_INPROGRESS) {
+        lookups.push_back(lookup);
+        return;
+    }
+    
+    // Answered (or refused) straight away
+    std::string host = lookup->host;
+    delete lookup;
+    if (err != ERR_OK) {
+        printf("DNS lookup failed immediately: %d\n", err);
+    }
+    complete(host, err == ERR_OK ? &addr : nullptr);
+}
+
+void DnsCache::complete(const std::string& host, const ip_addr_t* addr) {
+    Entry* entry = find(host);
+    if (entry == nullptr) {
+        return;
+    }
+    
+    uint32_t now = now_ms();
+    uint32_t lookup_ms = now - entry->lookup_started_ms;
+    stats.total_lookup_ms += lookup_ms;
+    stats.max_lookup_ms = std::max(stats.max_lookup_ms, lookup_ms);
+    entry->lookup_pending = false;
+    
+    if (addr) {
+        entry->resolved = true;
+        entry->addr = ip4_addr_get_u32(ip_2_ip4(addr));
+        entry->expires_ms = now + DNS_CACHE_TTL_MS;
+        entry->retry_after_ms = 0;
+    } else {
+        stats.failures++;
+        printf("DNS lookup failed for %s\n", host.c_str());
+        
+        // A still-usable old answer keeps being served; the refresh waits
+        entry->retry_after_ms = now + DNS_CACHE_NEGATIVE_TTL_MS;
+        if (entry->retry_after_ms == 0) {
+            entry->retry_after_ms = 1;
+        }
+        if (!entry->resolved || !before(now, entry->expires_ms + DNS_CACHE_STALE_MS)) {
+            entry->resolved = false;
+            entry->expires_ms = now + DNS_CACHE_NEGATIVE_TTL_MS;
+        }
+    }
+    if (entry->expires_ms == 0) {
+        entry->expires_ms = 1;
+    }
+    
+    ip_addr_t answer;
+    ip_addr_set_ip4_u32(&answer, entry->addr);
+    const ip_addr_t* result = entry->resolved ? &answer : nullptr;
+    
+    // Callbacks may resolve again - take the waiters off the entry first
+    std::vector<Waiter> waiters = std::move(entry->waiters);
+    entry->waiters.clear();
+    for (Waiter& waiter : waiters) {
+        waiter.callback(result, now - waiter.started_ms);
+    }
+}
+
+void DnsCache::dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg) {
+    (void)name;
+    Lookup* lookup = (Lookup*)arg;
+    DnsCache* cache = lookup->cache;
+    std::string host = lookup->host;
+    
+    if (cache) {
+        auto& pending = cache->lookups;
+        pending.erase(std::remove(pending.begin(), pending.end(), lookup), pending.end());
+    }
+    delete lookup;
+    
+    if (cache) {
+        cache->complete(host, ipaddr);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include <string>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+// Forward declarations to avoid header conflicts
+struct ip4_addr;
+typedef struct ip4_addr ip_addr_t;
+
+// Hosts remembered at once - the apps only talk to a handful of APIs
+#define DNS_CACHE_SIZE 8
+
+// lwIP does not hand record TTLs to callers, so answers are trusted for this
+// long. Asking again still goes through lwIP's own table, which applies the
+// real TTL, so a short-lived record is re-queried on the wire.
+#define DNS_CACHE_TTL_MS (5 * 60 * 1000)
+
+// Failed lookups are answered from the cache for this long
+#define DNS_CACHE_NEGATIVE_TTL_MS 10000
+
+// An expired answer is still handed out (and refreshed in the background)
+// for this long, so a slow resolver never delays a scheduled refresh
+#define DNS_CACHE_STALE_MS (60 * 60 * 1000)
+
+// Hosts used within DNS_CACHE_HOT_MS are re-resolved this long before expiry
+#define DNS_CACHE_PREFETCH_MS 30000
+#define DNS_CACHE_HOT_MS (30 * 60 * 1000)
+
+// Resolver cache in front of lwIP's dns_gethostbyname
+// Answers are served from the cache where possible. Lookups for the same host
+// are shared, and hosts in regular use are refreshed before they expire.
+class DnsCache {
+public:
+    // addr is nullptr if the host could not be resolved. dns_ms is how long
+    // this caller waited (0 for cached answers).
+    using ResolveCallback = std::function<void(const ip_addr_t* addr, uint32_t dns_ms)>;
+    
+    struct Stats {
+        uint32_t hits;
+        uint32_t stale_hits;     // Expired answer used while refreshing
+        uint32_t negative_hits;
+        uint32_t misses;
+        uint32_t lookups;        // Queries handed to lwIP
+        uint32_t failures;
+        uint32_t prefetches;
+        uint32_t total_lookup_ms;
+        uint32_t max_lookup_ms;
+    };
+    
+    DnsCache();
+    ~DnsCache();
+    
+    // Resolve host. Cached answers call back before returning and return 0;
+    // otherwise returns a lookup id for cancel().
+    uint32_t resolve(const std::string& host, ResolveCallback callback);
+    
+    // Drop the callback of a pending resolve
+    void cancel(uint32_t lookup_id);
+    
+    // Warm the cache for a host that is about to be used (apps call it from
+    // their playlist prefetch())
+    void prefetch(const std::string& host);
+    
+    // Refresh hot entries before they expire (call in main loop)
+    void process(uint32_t now_ms);
+    
+    const Stats& get_stats() const { return stats; }
+    
+private:
+    struct Waiter {
+        uint32_t id;
+        ResolveCallback callback;
+        uint32_t started_ms;
+    };
+    
+    struct Entry {
+        std::string host;
+        uint32_t addr;           // IPv4 address, network byte order
+        bool resolved;           // false: negative entry
+        uint32_t expires_ms;     // 0 = never answered
+        uint32_t last_used_ms;
+        bool lookup_pending;
+        uint32_t lookup_started_ms;
+        uint32_t retry_after_ms; // Refresh paused after a failure (0 = no pause)
+        std::vector<Waiter> waiters;
+    };
+    
+    // Handed to lwIP as the callback argument; outlives the cache if needed
+    struct Lookup {
+        DnsCache* cache;
+        std::string host;
+    };
+    
+    std::vector<Entry*> entries;
+    std::vector<Lookup*> lookups;
+    uint32_t next_id;
+    Stats stats;
+    
+    Entry* find(const std::string& host);
+    Entry* create(const std::string& host);
+    bool may_refresh(const Entry* entry, uint32_t now) const;
+    bool is_waiting(uint32_t lookup_id) const;
+    void start_lookup(Entry* entry);
+    void complete(const std::string& host, const ip_addr_t* addr);
+    
+    static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg);
+};
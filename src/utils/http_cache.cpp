@@ -0,0 +1,223 @@
+#include "http_cache.h"
+#include <cctype>
+#include <cstdio>
+
+static bool equals_ignore_case(const std::string& a, const char* b) {
+    size_t i = 0;
+    for (; i < a.length() && b[i]; i++) {
+        if (std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return i == a.length() && b[i] == '\0';
+}
+
+// Parse the digits at the start of value (stops at the first non-digit)
+static long parse_seconds(const std::string& value, size_t start) {
+    long seconds = 0;
+    for (size_t i = start; i < value.length() && value[i] >= '0' && value[i] <= '9'; i++) {
+        seconds = seconds * 10 + (value[i] - '0');
+        if (seconds > 0x7FFFFFF) {
+            break;  // Far beyond anything we would keep
+        }
+    }
+    return seconds;
+}
+
+void HttpCache::Capture::reset() {
+    etag.clear();
+    last_modified.clear();
+    max_age_s = -1;
+    age_s = 0;
+    no_store = false;
+    no_cache = false;
+    body.clear();
+    body_too_large = false;
+}
+
+void HttpCache::Capture::on_header(const std::string& name, const std::string& value) {
+    if (equals_ignore_case(name, "ETag")) {
+        etag = value;
+    } else if (equals_ignore_case(name, "Last-Modified")) {
+        last_modified = value;
+    } else if (equals_ignore_case(name, "Age")) {
+        age_s = (uint32_t)parse_seconds(value, 0);
+    } else if (equals_ignore_case(name, "Cache-Control")) {
+        // Comma-separated directives; only the ones a private cache needs
+        size_t pos = 0;
+        while (pos < value.length()) {
+            size_t end = value.find(',', pos);
+            if (end == std::string::npos) {
+                end = value.length();
+            }
+            size_t start = value.find_first_not_of(" \t", pos);
+            if (start != std::string::npos && start < end) {
+                std::string directive = value.substr(start, end - start);
+                size_t equals = directive.find('=');
+                std::string key = directive.substr(0, equals);
+                while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) {
+                    key.pop_back();
+                }
+                
+                if (equals_ignore_case(key, "max-age") && equals != std::string::npos) {
+                    max_age_s = (int32_t)parse_seconds(directive, directive.find_first_not_of(" \t\"", equals + 1));
+                } else if (equals_ignore_case(key, "no-store")) {
+                    no_store = true;
+                } else if (equals_ignore_case(key, "no-cache")) {
+                    no_cache = true;
+                }
+            }
+            pos = end + 1;
+        }
+    }
+}
+
+void HttpCache::Capture::on_body(std::string_view chunk) {
+    if (body_too_large) {
+        return;
+    }
+    if (body.length() + chunk.length() > HTTP_CACHE_MAX_BODY) {
+        body_too_large = true;
+        body.clear();
+        body.shrink_to_fit();
+        return;
+    }
+    body.append(chunk.data(), chunk.length());
+}
+
+HttpCache::HttpCache()
+    : total_bytes(0)
+    , stats{} {
+}
+
+HttpCache::Entry* HttpCache::find(const std::string& url) {
+    for (Entry& entry : entries) {
+        if (entry.url == url) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const HttpCache::Entry* HttpCache::find(const std::string& url) const {
+    for (const Entry& entry : entries) {
+        if (entry.url == url) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void HttpCache::remove(const std::string& url) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->url == url) {
+            total_bytes -= it->body.length();
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+void HttpCache::update_freshness(Entry& entry, const Capture& capture, uint32_t now_ms) {
+    entry.stored_ms = now_ms;
+    entry.last_used_ms = now_ms;
+    
+    // Freshness left = max-age minus the time it already spent in caches
+    uint32_t lifetime_s = 0;
+    if (!capture.no_cache && capture.max_age_s > 0 && (uint32_t)capture.max_age_s > capture.age_s) {
+        lifetime_s = (uint32_t)capture.max_age_s - capture.age_s;
+    }
+    entry.fresh_until_ms = now_ms + lifetime_s * 1000;
+}
+
+bool HttpCache::is_fresh(const std::string& url, uint32_t now_ms) const {
+    const Entry* entry = find(url);
+    
+    // Fresh while now is in [stored, fresh_until)
+    return entry && now_ms - entry->stored_ms < entry->fresh_until_ms - entry->stored_ms;
+}
+
+const std::string* HttpCache::lookup_fresh(const std::string& url, uint32_t now_ms) {
+    Entry* entry = find(url);
+    if (entry == nullptr || !is_fresh(url, now_ms)) {
+        return nullptr;
+    }
+    
+    entry->last_used_ms = now_ms;
+    stats.fresh_hits++;
+    stats.bytes_saved += entry->body.length();
+    return &entry->body;
+}
+
+std::string HttpCache::conditional_headers(const std::string& url) const {
+    const Entry* entry = find(url);
+    if (entry == nullptr) {
+        return "";
+    }
+    
+    std::string headers;
+    if (!entry->etag.empty()) {
+        headers += "If-None-Match: " + entry->etag + "\r\n";
+    }
+    if (!entry->last_modified.empty()) {
+        headers += "If-Modified-Since: " + entry->last_modified + "\r\n";
+    }
+    return headers;
+}
+
+void HttpCache::store(const std::string& url, const Capture& capture, uint32_t now_ms) {
+    bool has_validator = !capture.etag.empty() || !capture.last_modified.empty();
+    bool has_lifetime = !capture.no_cache && capture.max_age_s > 0;
+    
+    if (capture.no_store || capture.body_too_large || (!has_validator && !has_lifetime)) {
+        remove(url);
+        return;
+    }
+    
+    remove(url);
+    
+    // Evict least recently used entries until the new body fits
+    while (!entries.empty() &&
+           (entries.size() >= HTTP_CACHE_MAX_ENTRIES || total_bytes + capture.body.length() > HTTP_CACHE_MAX_BYTES)) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if ((int32_t)(it->last_used_ms - oldest->last_used_ms) < 0) {
+                oldest = it;
+            }
+        }
+        total_bytes -= oldest->body.length();
+        entries.erase(oldest);
+    }
+    
+    Entry entry;
+    entry.url = url;
+    entry.etag = capture.etag;
+    entry.last_modified = capture.last_modified;
+    entry.body = capture.body;
+    update_freshness(entry, capture, now_ms);
+    
+    total_bytes += entry.body.length();
+    entries.push_back(std::move(entry));
+    stats.stored++;
+}
+
+const std::string* HttpCache::revalidated(const std::string& url, const Capture& capture, uint32_t now_ms) {
+    Entry* entry = find(url);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    
+    // A 304 may carry updated validators and freshness
+    if (!capture.etag.empty()) {
+        entry->etag = capture.etag;
+    }
+    if (!capture.last_modified.empty()) {
+        entry->last_modified = capture.last_modified;
+    }
+    update_freshness(*entry, capture, now_ms);
+    
+    stats.revalidated++;
+    stats.bytes_saved += entry->body.length();
+    printf("HttpCache: %s not modified - %u bytes from cache\n", url.c_str(), (unsigned)entry->body.length());
+    return &entry->body;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Responses kept at once, and the memory they may use. API responses are a
+// few hundred bytes to a few KB; anything larger is simply not cached.
+#define HTTP_CACHE_MAX_ENTRIES 6
+#define HTTP_CACHE_MAX_BODY 4096
+#define HTTP_CACHE_MAX_BYTES 12288
+
+// Response cache keyed by URL
+// Stores the body with its validators (ETag, Last-Modified) and freshness
+// (Cache-Control max-age minus Age). Fresh entries are served without a
+// request; stale ones are revalidated with If-None-Match/If-Modified-Since,
+// and a 304 replays the stored body.
+class HttpCache {
+public:
+    // What one response said about caching, collected as it streams in
+    struct Capture {
+        std::string etag;
+        std::string last_modified;
+        int32_t max_age_s;      // -1 = not given
+        uint32_t age_s;
+        bool no_store;
+        bool no_cache;          // Store, but revalidate every time
+        std::string body;
+        bool body_too_large;
+        
+        Capture() { reset(); }
+        void reset();
+        void on_header(const std::string& name, const std::string& value);
+        void on_body(std::string_view chunk);
+    };
+    
+    struct Stats {
+        uint32_t fresh_hits;     // Served without touching the network
+        uint32_t revalidated;    // 304 - body replayed from the cache
+        uint32_t stored;
+        uint32_t bytes_saved;    // Body bytes not transferred thanks to the cache
+    };
+    
+    HttpCache();
+    
+    // Body of a fresh entry, or nullptr if the URL has to be fetched
+    const std::string* lookup_fresh(const std::string& url, uint32_t now_ms);
+    bool is_fresh(const std::string& url, uint32_t now_ms) const;
+    
+    // Conditional request headers (CRLF-terminated lines) for a cached URL
+    std::string conditional_headers(const std::string& url) const;
+    
+    // A successful response finished - keep it if its headers allow
+    void store(const std::string& url, const Capture& capture, uint32_t now_ms);
+    
+    // The server answered 304 - update freshness and return the stored body
+    // (nullptr if the entry is gone)
+    const std::string* revalidated(const std::string& url, const Capture& capture, uint32_t now_ms);
+    
+    const Stats& get_stats() const { return stats; }
+    
+private:
+    struct Entry {
+        std::string url;
+        std::string etag;
+        std::string last_modified;
+        std::string body;
+        uint32_t stored_ms;
+        uint32_t fresh_until_ms;  // Equal to stored_ms when it must be revalidated
+        uint32_t last_used_ms;
+    };
+    
+    std::vector<Entry> entries;
+    size_t total_bytes;
+    Stats stats;
+    
+    Entry* find(const std::string& url);
+    const Entry* find(const std::string& url) const;
+    void remove(const std::string& url);
+    void update_freshness(Entry& entry, const Capture& capture, uint32_t now_ms);
+};
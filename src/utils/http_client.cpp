@@ -0,0 +1,653 @@
+#include "http_client.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <algorithm>
+
+#ifdef HTTP_HOST_BUILD
+#include <chrono>
+
+static uint32_t now_ms() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+#else
+static uint32_t now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+#endif
+
+// Deadline helper: 0 timeout means no deadline
+static uint32_t deadline_after(uint32_t now, uint32_t timeout_ms) {
+    if (timeout_ms == 0) {
+        return 0;
+    }
+    uint32_t deadline = now + timeout_ms;
+    return deadline != 0 ? deadline : 1;
+}
+
+static bool deadline_passed(uint32_t now, uint32_t deadline) {
+    return deadline != 0 && (int32_t)(now - deadline) >= 0;
+}
+
+HttpClient::HttpClient(size_t max_connections, size_t max_pipeline)
+    : max_connections(max_connections > 0 ? max_connections : 1)
+    , max_pipeline(max_pipeline > 0 ? max_pipeline : 1)
+    , request_queue(
+          [this](uint32_t fetch_id, const std::string& url, const RequestOptions& options,
+                 const std::string& extra_headers, RequestQueue::HeaderCallback on_header,
+                 BodyCallback on_body, RequestQueue::ResultCallback on_result) {
+              start_request(fetch_id, url, options, extra_headers, on_header, on_body, on_result);
+          },
+          [this](uint32_t fetch_id) {
+              abort_request(fetch_id);
+          },
+          (max_connections > 0 ? max_connections : 1) * (max_pipeline > 0 ? max_pipeline : 1))
+    , route_count(0) {
+}
+
+HttpClient::~HttpClient() {
+    for (Connection* connection : connections) {
+        close_link(connection, true);
+        for (Request* request : connection->requests) {
+            if (request->cancelled) {
+                delete request;  // Not tracked in active_requests any more
+            }
+        }
+        connection->requests.clear();
+        delete connection;
+    }
+    connections.clear();
+    
+    for (Request* request : active_requests) {
+        delete request;
+    }
+    active_requests.clear();
+}
+
+void HttpClient::add_transport(const char* scheme, HttpTransport* transport) {
+    if (route_count >= HTTP_MAX_TRANSPORTS) {
+        printf("HttpClient: No room for transport %s\n", scheme);
+        return;
+    }
+    routes[route_count++] = {scheme, transport};
+}
+
+void HttpClient::process(uint32_t now) {
+    check_deadlines(now);
+    check_drain_deadlines(now);
+    close_idle(now);
+    request_queue.process(now);
+    for (size_t i = 0; i < route_count; i++) {
+        routes[i].transport->process(now);
+    }
+}
+
+void HttpClient::check_deadlines(uint32_t now) {
+    // Iterate over a copy - finishing a request edits the list
+    std::vector<Request*> requests = active_requests;
+    for (Request* request : requests) {
+        // An earlier failure in this pass may already have finished it
+        if (std::find(active_requests.begin(), active_requests.end(), request) == active_requests.end()) {
+            continue;
+        }
+        
+        HttpError error = HttpError::NONE;
+        if (deadline_passed(now, request->total_deadline_ms)) {
+            error = HttpError::TOTAL_TIMEOUT;
+        } else if (deadline_passed(now, request->phase_deadline_ms)) {
+            error = (request->phase == RequestPhase::CONNECTING) ? HttpError::CONNECT_TIMEOUT
+                                                                  : HttpError::FIRST_BYTE_TIMEOUT;
+        }
+        if (error == HttpError::NONE) {
+            continue;
+        }
+        
+        printf("HttpClient: Request to %s timed out (%s)\n", request->host.c_str(), http_error_name(error));
+        
+        // Once a request is on the wire its response would arrive out of
+        // order, so the whole connection has to go. A connection still being
+        // set up is dropped when nobody else is waiting for it.
+        Connection* connection = request->connection;
+        bool drop_connection = connection && (request->sent || connection->requests.size() == 1);
+        if (drop_connection) {
+            connection->state = ConnectionState::CLOSING;
+        }
+        
+        finish_request(request, error);
+        
+        if (drop_connection) {
+            fail_connection(connection, HttpError::CONNECTION_LOST);
+        }
+    }
+}
+
+void HttpClient::check_drain_deadlines(uint32_t now) {
+    // Cancelled responses left draining are no longer in active_requests;
+    // a stalled one would otherwise hold its pool slot for ever
+    std::vector<Connection*> pool = connections;
+    for (Connection* connection : pool) {
+        // An earlier failure in this pass may already have freed it
+        if (std::find(connections.begin(), connections.end(), connection) == connections.end()) {
+            continue;
+        }
+        
+        for (Request* request : connection->requests) {
+            if (request->cancelled && (deadline_passed(now, request->total_deadline_ms) ||
+                                       deadline_passed(now, request->phase_deadline_ms))) {
+                printf("HttpClient: Cancelled response from %s stalled, dropping the connection\n",
+                       connection->host.c_str());
+                connection->state = ConnectionState::CLOSING;
+                fail_connection(connection, HttpError::CONNECTION_LOST);
+                break;
+            }
+        }
+    }
+}
+
+void HttpClient::close_idle(uint32_t now) {
+    std::vector<Connection*> pool = connections;
+    for (Connection* connection : pool) {
+        if (connection->state == ConnectionState::READY && connection->requests.empty() &&
+            now - connection->idle_since_ms >= HTTP_IDLE_TIMEOUT_MS) {
+            printf("HttpClient: Closing idle connection to %s\n", connection->host.c_str());
+            release_connection(connection);
+        }
+    }
+}
+
+void HttpClient::close_idle_connections() {
+    std::vector<Connection*> pool = connections;
+    for (Connection* connection : pool) {
+        if (connection->requests.empty() && !connection->in_recv) {
+            release_connection(connection);
+        }
+    }
+}
+
+void HttpClient::fail_all(HttpError error) {
+    // Requests still waiting for a slot first, so no new connection opens
+    std::vector<Request*> waiting;
+    for (Request* request : active_requests) {
+        if (request->connection == nullptr) {
+            waiting.push_back(request);
+        }
+    }
+    for (Request* request : waiting) {
+        if (std::find(active_requests.begin(), active_requests.end(), request) != active_requests.end()) {
+            finish_request(request, error);
+        }
+    }
+    
+    while (!connections.empty()) {
+        fail_connection(connections.back(), error);
+    }
+}
+
+bool HttpClient::parse_url(const std::string& url, HttpTransport*& transport, std::string& host, uint16_t& port,
+                           std::string& path) {
+    // scheme://host[:port][/path]
+    size_t protocol_end = url.find("://");
+    if (protocol_end == std::string::npos) {
+        return false;
+    }
+    
+    std::string scheme = url.substr(0, protocol_end);
+    transport = nullptr;
+    for (size_t i = 0; i < route_count; i++) {
+        if (scheme == routes[i].scheme) {
+            transport = routes[i].transport;
+        }
+    }
+    if (transport == nullptr) {
+        return false;
+    }
+    
+    size_t host_start = protocol_end + 3;
+    size_t path_start = url.find('/', host_start);
+    if (path_start == std::string::npos) {
+        host = url.substr(host_start);
+        path = "/";
+    } else {
+        host = url.substr(host_start, path_start - host_start);
+        path = url.substr(path_start);
+    }
+    
+    port = transport->default_port();
+    size_t colon = host.find(':');
+    if (colon != std::string::npos) {
+        long value = strtol(host.c_str() + colon + 1, nullptr, 10);
+        if (value <= 0 || value > 65535) {
+            return false;
+        }
+        port = (uint16_t)value;
+        host.erase(colon);
+    }
+    return !host.empty();
+}
+
+// ---------------------------------------------------------------------------
+// Connection pool
+// ---------------------------------------------------------------------------
+
+bool HttpClient::dispatch(Request* request) {
+    // Reuse a pooled connection to the same host if its pipeline has room
+    for (Connection* connection : connections) {
+        if (connection->transport == request->transport && connection->host == request->host &&
+            connection->port == request->port && connection->state != ConnectionState::CLOSING &&
+            connection->requests.size() < max_pipeline) {
+            connection->requests.push_back(request);
+            request->connection = connection;
+            if (connection->state == ConnectionState::READY && !connection->in_recv) {
+                send_request(connection, request);
+            }
+            return true;
+        }
+    }
+    
+    // Make room by closing an idle connection to another host
+    if (connections.size() >= max_connections) {
+        for (Connection* connection : connections) {
+            if (connection->state == ConnectionState::READY && connection->requests.empty() &&
+                !connection->in_recv) {
+                release_connection(connection);
+                break;
+            }
+        }
+        
+        // Closing it lets waiting requests in - this one may be among them
+        if (request->connection) {
+            return true;
+        }
+    }
+    if (connections.size() >= max_connections) {
+        return false;  // Wait for a connection to free up
+    }
+    
+    Connection* connection = new Connection();
+    connection->client = this;
+    connection->transport = request->transport;
+    connection->host = request->host;
+    connection->port = request->port;
+    connection->link = request->transport->create(request->host, request->port);
+    connection->state = ConnectionState::CONNECTING;
+    connection->idle_since_ms = now_ms();
+    connection->in_recv = false;
+    connections.push_back(connection);
+    
+    connection->requests.push_back(request);
+    request->connection = connection;
+    
+    // May fail straight away (e.g. a cached DNS failure), taking the
+    // connection and the request with it
+    connection->link->connect(connection);
+    return true;
+}
+
+void HttpClient::dispatch_waiting() {
+    std::vector<Request*> waiting;
+    for (Request* request : active_requests) {
+        if (request->connection == nullptr) {
+            waiting.push_back(request);
+        }
+    }
+    
+    for (Request* request : waiting) {
+        bool still_waiting = std::find(active_requests.begin(), active_requests.end(), request) != active_requests.end() &&
+                             request->connection == nullptr;
+        if (still_waiting) {
+            dispatch(request);
+        }
+    }
+}
+
+bool HttpClient::send_request(Connection* connection, Request* request) {
+    // HTTP/1.1 keeps the connection open by default
+    std::string request_text = "GET " + request->path + " HTTP/1.1\r\n";
+    request_text += "Host: " + request->host;
+    if (request->port != request->transport->default_port()) {
+        request_text += ":" + std::to_string(request->port);
+    }
+    request_text += "\r\n";
+    request_text += request->extra_headers;
+    // Compression only while the one static decoder is free for this response
+    if (request->decoder_slot || ContentDecoder::claim_slot()) {
+        request->decoder_slot = true;
+        request->parser.set_decoding_allowed(true);
+        request_text += HTTP_ACCEPT_ENCODING_HEADER;
+    }
+    request_text += "User-Agent: PicoW-Weather/1.0\r\n";
+    request_text += "\r\n";
+    
+    HttpError error = connection->link ? connection->link->write(request_text) : HttpError::CONNECTION_LOST;
+    if (error != HttpError::NONE) {
+        fail_connection(connection, error);
+        return false;
+    }
+    
+    // The first-byte deadline starts once the request is next in line
+    request->sent = true;
+    request->phase = RequestPhase::AWAITING_RESPONSE;
+    bool is_front = connection->requests.front() == request;
+    request->phase_deadline_ms = is_front ? deadline_after(now_ms(), request->first_byte_timeout_ms) : 0;
+    return true;
+}
+
+bool HttpClient::send_pending(Connection* connection) {
+    // Pipeline everything that queued up meanwhile
+    std::vector<Request*> requests = connection->requests;
+    for (Request* request : requests) {
+        if (!request->sent && !send_request(connection, request)) {
+            return false;  // Connection was failed
+        }
+    }
+    return true;
+}
+
+void HttpClient::close_link(Connection* connection, bool abort) {
+    TransportConnection* link = connection->link;
+    if (link) {
+        connection->link = nullptr;
+        link->close(abort);
+    }
+}
+
+void HttpClient::fail_connection(Connection* connection, HttpError error) {
+    close_link(connection, true);
+    connection->state = ConnectionState::CLOSING;
+    connections.erase(std::remove(connections.begin(), connections.end(), connection), connections.end());
+    
+    // Fail everything still queued on it - requests without body data retry
+    std::vector<Request*> requests = std::move(connection->requests);
+    connection->requests.clear();
+    for (Request* request : requests) {
+        request->connection = nullptr;
+        if (request->cancelled) {
+            delete request;
+        } else {
+            finish_request(request, error);
+        }
+    }
+    
+    delete connection;
+    
+    dispatch_waiting();
+}
+
+void HttpClient::release_connection(Connection* connection) {
+    close_link(connection, false);
+    connections.erase(std::remove(connections.begin(), connections.end(), connection), connections.end());
+    delete connection;
+    
+    dispatch_waiting();
+}
+
+// ---------------------------------------------------------------------------
+// Request completion
+// ---------------------------------------------------------------------------
+
+void HttpClient::finish_request(Request* request, HttpError error) {
+    active_requests.erase(std::remove(active_requests.begin(), active_requests.end(), request), active_requests.end());
+    
+    Connection* connection = request->connection;
+    if (connection) {
+        auto& queued = connection->requests;
+        queued.erase(std::remove(queued.begin(), queued.end(), request), queued.end());
+        if (queued.empty()) {
+            connection->idle_since_ms = now_ms();
+        }
+        request->connection = nullptr;
+    }
+    
+    if (error != HttpError::NONE && error != HttpError::CANCELLED) {
+        printf("HttpClient: Request to %s failed: %s (status %d)\n", request->host.c_str(),
+               http_error_name(error), request->parser.get_status_code());
+    }
+    
+    if (error == HttpError::NONE && request->parser.is_compressed()) {
+        printf("HttpClient: Response from %s: %u bytes inflated from %u\n", request->host.c_str(),
+               (unsigned)request->parser.get_decoded_bytes(), (unsigned)request->parser.get_encoded_bytes());
+    }
+    
+    RequestQueue::ResultCallback on_result = request->on_result;
+    int status_code = request->parser.get_status_code();
+    
+    // Free the request before notifying - the callback may start the next one
+    delete request;
+    
+    if (on_result) {
+        on_result(error, status_code);
+    }
+}
+
+void HttpClient::complete_front(Connection* connection, bool peer_closed) {
+    Request* request = connection->requests.front();
+    connection->requests.erase(connection->requests.begin());
+    request->connection = nullptr;
+    
+    if (connection->requests.empty()) {
+        connection->idle_since_ms = now_ms();
+    } else {
+        // The next pipelined response is now due
+        Request* next = connection->requests.front();
+        if (next->sent) {
+            next->phase_deadline_ms = deadline_after(now_ms(), next->first_byte_timeout_ms);
+        }
+    }
+    
+    HttpResponseParser& parser = request->parser;
+    HttpError error = HttpError::NONE;
+    if (parser.is_complete()) {
+        error = parser.is_success() ? HttpError::NONE : HttpError::HTTP_STATUS;
+    } else if (peer_closed) {
+        error = HttpError::CONNECTION_LOST;
+    } else {
+        error = HttpError::BAD_RESPONSE;
+    }
+    
+    if (request->cancelled) {
+        delete request;  // Caller already told - response just drained
+    } else {
+        finish_request(request, error);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Transport events
+// ---------------------------------------------------------------------------
+
+void HttpClient::on_connected(Connection* connection) {
+    connection->state = ConnectionState::READY;
+    connection->idle_since_ms = now_ms();
+    send_pending(connection);
+}
+
+void HttpClient::on_data(Connection* connection, std::string_view data) {
+    // One buffer may finish a response and start the next pipelined one,
+    // so leftover bytes move down the line
+    bool must_close = false;
+    connection->in_recv = true;
+    while (!data.empty()) {
+        if (connection->requests.empty()) {
+            must_close = true;  // Data nobody asked for
+            break;
+        }
+        
+        Request* front = connection->requests.front();
+        if (front->phase == RequestPhase::AWAITING_RESPONSE) {
+            front->phase = RequestPhase::RECEIVING;
+            front->phase_deadline_ms = 0;
+        }
+        
+        HttpResponseParser& parser = front->parser;
+        data.remove_prefix(parser.feed(data));
+        
+        if (parser.is_complete() || parser.has_error()) {
+            if (!parser.is_complete() || !parser.is_keep_alive()) {
+                connection->state = ConnectionState::CLOSING;
+                must_close = true;
+            }
+            complete_front(connection, false);
+            if (must_close) {
+                break;
+            }
+        }
+    }
+    connection->in_recv = false;
+    
+    if (must_close) {
+        close_link(connection, false);
+        fail_connection(connection, HttpError::CONNECTION_LOST);
+        return;
+    }
+    
+    // Send whatever the completion callbacks queued onto this connection
+    if (connection->state == ConnectionState::READY) {
+        send_pending(connection);
+    }
+}
+
+void HttpClient::on_closed(Connection* connection, HttpError error) {
+    // The transport frees the link once this returns
+    connection->link = nullptr;
+    connection->state = ConnectionState::CLOSING;
+    
+    if (error == HttpError::NONE) {
+        // Server closed - completes a body without a length
+        if (!connection->requests.empty()) {
+            Request* front = connection->requests.front();
+            front->parser.finish();
+            if (front->parser.is_complete()) {
+                complete_front(connection, true);
+            }
+        }
+        error = HttpError::CONNECTION_LOST;
+    }
+    
+    fail_connection(connection, error);
+}
+
+// ---------------------------------------------------------------------------
+// Public request API
+// ---------------------------------------------------------------------------
+
+uint32_t HttpClient::get(const std::string& url, std::function<void(const std::string&)> callback,
+                         const RequestOptions& options) {
+    auto body = std::make_shared<std::string>();
+    return get_stream(url,
+        [body](std::string_view chunk) {
+            body->append(chunk.data(), chunk.size());
+        },
+        [body, callback](bool success) {
+            if (success && callback) {
+                callback(*body);
+            }
+        },
+        options);
+}
+
+uint32_t HttpClient::get_stream(const std::string& url, BodyCallback on_body, CompleteCallback on_complete,
+                                const RequestOptions& options, ErrorCallback on_error) {
+    request_queue.process(now_ms());
+    return request_queue.enqueue(url, options, on_body, on_complete, on_error);
+}
+
+bool HttpClient::cancel(uint32_t request_id) {
+    return request_queue.cancel(request_id);
+}
+
+void HttpClient::abort_request(uint32_t fetch_id) {
+    for (Request* request : active_requests) {
+        if (request->fetch_id != fetch_id) {
+            continue;
+        }
+        
+        Connection* connection = request->connection;
+        if (connection && request->sent) {
+            // Alone on its connection, which no event is working on right
+            // now: nothing to keep in step, so close instead of draining
+            if (connection->requests.size() == 1 && !connection->in_recv &&
+                connection->state != ConnectionState::CLOSING) {
+                connection->state = ConnectionState::CLOSING;
+                finish_request(request, HttpError::CANCELLED);
+                fail_connection(connection, HttpError::CANCELLED);
+                return;
+            }
+            
+            // Its response is still coming - drain it so later pipelined
+            // responses stay in step, but tell the caller now. The drain
+            // gets a deadline of its own (check_drain_deadlines).
+            active_requests.erase(std::remove(active_requests.begin(), active_requests.end(), request),
+                                  active_requests.end());
+            RequestQueue::ResultCallback on_result = request->on_result;
+            request->cancelled = true;
+            request->on_result = nullptr;
+            uint32_t drain_deadline = now_ms() + HTTP_DRAIN_TIMEOUT_MS;
+            if (drain_deadline == 0) {
+                drain_deadline = 1;
+            }
+            if (request->total_deadline_ms == 0 || (int32_t)(drain_deadline - request->total_deadline_ms) < 0) {
+                request->total_deadline_ms = drain_deadline;
+            }
+            // The body callback may be running right now (cancel from inside
+            // it) - it is left in place and stops forwarding instead
+            if (on_result) {
+                on_result(HttpError::CANCELLED, 0);
+            }
+            return;
+        }
+        
+        finish_request(request, HttpError::CANCELLED);
+        
+        // Nobody else needs a connection that is still being set up
+        if (connection && connection->requests.empty() && connection->state != ConnectionState::READY) {
+            fail_connection(connection, HttpError::CANCELLED);
+        }
+        return;
+    }
+}
+
+void HttpClient::start_request(uint32_t fetch_id, const std::string& url, const RequestOptions& options,
+                               const std::string& extra_headers, RequestQueue::HeaderCallback on_header,
+                               BodyCallback on_body, RequestQueue::ResultCallback on_result) {
+    HttpTransport* transport = nullptr;
+    std::string host, path;
+    uint16_t port = 0;
+    
+    if (!parse_url(url, transport, host, port, path)) {
+        printf("HttpClient: Invalid or unsupported URL: %s\n", url.c_str());
+        on_result(HttpError::INVALID_URL, 0);
+        return;
+    }
+    
+    printf("HttpClient: GET %s%s\n", host.c_str(), path.c_str());
+    
+    uint32_t now = now_ms();
+    
+    // Prepare request state
+    Request* request = new Request();
+    request->fetch_id = fetch_id;
+    request->transport = transport;
+    request->host = host;
+    request->port = port;
+    request->path = path;
+    request->extra_headers = extra_headers;
+    request->connection = nullptr;
+    request->sent = false;
+    request->cancelled = false;
+    request->parser.set_header_callback(on_header);
+    request->parser.set_body_callback([request, on_body](std::string_view chunk) {
+        if (!request->cancelled && on_body) {
+            on_body(chunk);
+        }
+    });
+    request->on_result = on_result;
+    request->phase = RequestPhase::CONNECTING;
+    request->first_byte_timeout_ms = options.first_byte_timeout_ms;
+    request->phase_deadline_ms = deadline_after(now, options.connect_timeout_ms);
+    request->total_deadline_ms = deadline_after(now, options.total_timeout_ms);
+    active_requests.push_back(request);
+    
+    // Attach to a pooled connection, open a new one, or wait for a slot
+    dispatch(request);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#ifndef HTTP_HOST_BUILD
+#include "pico/stdlib.h"
+#endif
+#include "http_transport.h"
+#include "http_response_parser.h"
+#include "request_queue.h"
+#include <string>
+#include <string_view>
+#include <functional>
+#include <vector>
+
+// Keep-alive connections with nothing to do are closed after this long
+#define HTTP_IDLE_TIMEOUT_MS 15000
+
+// A cancelled response still being drained off a pipelined connection must
+// finish within this long, or the connection is dropped to free its slot
+#define HTTP_DRAIN_TIMEOUT_MS 5000
+
+// Most URL schemes one client can route
+#define HTTP_MAX_TRANSPORTS 2
+
+// HTTP/1.1 client core over pluggable transports
+// Owns the request queue, the keep-alive connection pool, request pipelining
+// and deadlines. How bytes reach a host (plain TCP, TLS, host sockets) is up
+// to the HttpTransport registered for the URL's scheme. Builds for a Linux
+// host too (HTTP_HOST_BUILD, see host/CMakeLists.txt).
+class HttpClient {
+public:
+    // Streaming callbacks: body bytes are delivered as each buffer arrives
+    // Chunks are views into the receive buffers, valid only during the call
+    using BodyCallback = RequestQueue::BodyCallback;
+    using CompleteCallback = RequestQueue::CompleteCallback;
+    using ErrorCallback = RequestQueue::ErrorCallback;
+    
+    // Connections open at once, and requests sent back-to-back on each
+    HttpClient(size_t max_connections, size_t max_pipeline);
+    ~HttpClient();
+    
+    // Route URLs with this scheme ("http", "https") through transport
+    void add_transport(const char* scheme, HttpTransport* transport);
+    
+    // GET with the whole body collected into one string - only for small responses
+    uint32_t get(const std::string& url, std::function<void(const std::string&)> callback,
+                 const RequestOptions& options = RequestOptions());
+    
+    // GET with the body streamed as it arrives. Requests are queued; each one
+    // gets its own callbacks. on_error (optional) reports why a request failed
+    // before on_complete(false) is called. Requests to the same host share a
+    // keep-alive connection. Returns a request id for cancel(), or 0 if rejected.
+    uint32_t get_stream(const std::string& url, BodyCallback on_body, CompleteCallback on_complete,
+                        const RequestOptions& options = RequestOptions(), ErrorCallback on_error = nullptr);
+    
+    // Cancel a queued or in-flight request; its callbacks will not be called
+    bool cancel(uint32_t request_id);
+    
+    // Close all pooled connections that have nothing to do
+    void close_idle_connections();
+    
+    // Fail every started request and drop all connections (e.g. link lost)
+    void fail_all(HttpError error);
+    
+    const RequestQueue& get_queue() const { return request_queue; }
+    
+    // Deadlines, idle connections and transport housekeeping (call in main loop)
+    void process(uint32_t now_ms);
+    
+private:
+    enum class RequestPhase : uint8_t {
+        CONNECTING,         // Waiting for a connection (DNS + TCP + TLS)
+        AWAITING_RESPONSE,  // Request sent, nothing received for it yet
+        RECEIVING
+    };
+    
+    enum class ConnectionState : uint8_t {
+        CONNECTING,
+        READY,
+        CLOSING             // Server asked to close - no new requests
+    };
+    
+    struct Connection;
+    
+    // State of one started request
+    struct Request {
+        uint32_t fetch_id;
+        HttpTransport* transport;
+        std::string host;            // Host name, without the port
+        uint16_t port;
+        std::string path;
+        std::string extra_headers;   // CRLF-terminated lines from the request queue
+        Connection* connection;      // nullptr while waiting for a pool slot
+        bool sent;
+        bool cancelled;              // Response still has to be drained off the connection
+        HttpResponseParser parser;
+        RequestQueue::ResultCallback on_result;
+        RequestPhase phase;
+        uint32_t first_byte_timeout_ms;
+        uint32_t phase_deadline_ms;  // Connect or first-byte deadline (0 = none)
+        uint32_t total_deadline_ms;  // 0 = none
+        bool decoder_slot;           // Holds ContentDecoder's slot - may get a compressed body
+        
+        ~Request() {
+            if (decoder_slot) {
+                ContentDecoder::release_slot();
+            }
+        }
+    };
+    
+    // One pooled keep-alive connection
+    struct Connection : public TransportListener {
+        HttpClient* client;
+        HttpTransport* transport;
+        std::string host;
+        uint16_t port;
+        TransportConnection* link;       // nullptr once the transport is gone
+        ConnectionState state;
+        std::vector<Request*> requests;  // Response order; front is being received
+        uint32_t idle_since_ms;
+        bool in_recv;                    // Delivering responses - don't write or free it yet
+        
+        void on_connected(TransportConnection*) override { client->on_connected(this); }
+        void on_data(TransportConnection*, std::string_view data) override { client->on_data(this, data); }
+        void on_closed(TransportConnection*, HttpError error) override { client->on_closed(this, error); }
+    };
+    
+    struct Route {
+        const char* scheme;
+        HttpTransport* transport;
+    };
+    
+    size_t max_connections;
+    size_t max_pipeline;
+    RequestQueue request_queue;
+    Route routes[HTTP_MAX_TRANSPORTS];
+    size_t route_count;
+    std::vector<Request*> active_requests;
+    std::vector<Connection*> connections;
+    
+    void start_request(uint32_t fetch_id, const std::string& url, const RequestOptions& options,
+                       const std::string& extra_headers, RequestQueue::HeaderCallback on_header,
+                       BodyCallback on_body, RequestQueue::ResultCallback on_result);
+    void abort_request(uint32_t fetch_id);
+    void check_deadlines(uint32_t now);
+    void check_drain_deadlines(uint32_t now);
+    void close_idle(uint32_t now);
+    bool parse_url(const std::string& url, HttpTransport*& transport, std::string& host, uint16_t& port,
+                   std::string& path);
+    
+    // Connection pool
+    bool dispatch(Request* request);
+    void dispatch_waiting();
+    bool send_request(Connection* connection, Request* request);
+    bool send_pending(Connection* connection);
+    void close_link(Connection* connection, bool abort);
+    void fail_connection(Connection* connection, HttpError error);
+    void release_connection(Connection* connection);
+    
+    void finish_request(Request* request, HttpError error);
+    void complete_front(Connection* connection, bool peer_closed);
+    
+    // Transport events
+    void on_connected(Connection* connection);
+    void on_data(Connection* connection, std::string_view data);
+    void on_closed(Connection* connection, HttpError error);
+};
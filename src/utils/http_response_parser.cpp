@@ -0,0 +1,289 @@
+#include "http_response_parser.h"
+#include <algorithm>
+#include <cctype>
+
+HttpResponseParser::HttpResponseParser()
+    : decoding_allowed(false) {
+    line.reserve(64);
+    reset();
+}
+
+void HttpResponseParser::reset() {
+    state = State::STATUS_LINE;
+    line.clear();
+    status_code = 0;
+    content_length = -1;
+    body_remaining = 0;
+    chunked = false;
+    keep_alive = true;  // HTTP/1.1 default
+    content_encoding = ContentDecoder::Encoding::IDENTITY;
+    decoder.reset();
+}
+
+static bool equals_ignore_case(const std::string& a, const char* b) {
+    size_t i = 0;
+    for (; i < a.length() && b[i] != '\0'; i++) {
+        if (std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return i == a.length() && b[i] == '\0';
+}
+
+static bool contains_ignore_case(const std::string& haystack, const char* needle) {
+    std::string lower = haystack;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower.find(needle) != std::string::npos;
+}
+
+bool HttpResponseParser::collect_line(char c) {
+    if (c == '\n') {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        return true;
+    }
+    if (line.length() < HTTP_PARSER_MAX_LINE) {
+        line += c;
+    }
+    return false;
+}
+
+bool HttpResponseParser::handle_status_line() {
+    // "HTTP/1.1 200 OK"
+    if (line.compare(0, 5, "HTTP/") != 0) {
+        return false;
+    }
+    size_t space = line.find(' ');
+    if (space == std::string::npos || space + 4 > line.length()) {
+        return false;
+    }
+    
+    status_code = 0;
+    for (size_t i = space + 1; i < space + 4; i++) {
+        if (line[i] < '0' || line[i] > '9') {
+            return false;
+        }
+        status_code = status_code * 10 + (line[i] - '0');
+    }
+    
+    // HTTP/1.0 closes by default
+    if (line.compare(0, 8, "HTTP/1.0") == 0) {
+        keep_alive = false;
+    }
+    return true;
+}
+
+void HttpResponseParser::handle_header_line() {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        return;  // Malformed header - ignore it
+    }
+    
+    std::string name = line.substr(0, colon);
+    size_t value_start = line.find_first_not_of(" \t", colon + 1);
+    std::string value = (value_start == std::string::npos) ? "" : line.substr(value_start);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.pop_back();
+    }
+    
+    if (equals_ignore_case(name, "Content-Length")) {
+        long length = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9') break;
+            length = length * 10 + (c - '0');
+        }
+        content_length = length;
+    } else if (equals_ignore_case(name, "Transfer-Encoding")) {
+        chunked = contains_ignore_case(value, "chunked");
+    } else if (equals_ignore_case(name, "Content-Encoding")) {
+        content_encoding = ContentDecoder::parse_encoding(value);
+    } else if (equals_ignore_case(name, "Connection")) {
+        if (contains_ignore_case(value, "close")) {
+            keep_alive = false;
+        } else if (contains_ignore_case(value, "keep-alive")) {
+            keep_alive = true;
+        }
+    }
+    
+    if (header_callback) {
+        header_callback(name, value);
+    }
+}
+
+void HttpResponseParser::begin_body() {
+    // 1xx, 204 and 304 responses never carry a body
+    if ((status_code >= 100 && status_code < 200) || status_code == 204 || status_code == 304) {
+        state = State::DONE;
+        return;
+    }
+    
+    if (content_encoding == ContentDecoder::Encoding::UNSUPPORTED) {
+        state = State::ERROR;  // We only ever ask for gzip/deflate
+        return;
+    }
+    if (content_encoding != ContentDecoder::Encoding::IDENTITY && !decoding_allowed) {
+        state = State::ERROR;  // Compression was not asked for (decoder busy)
+        return;
+    }
+    if (content_encoding != ContentDecoder::Encoding::IDENTITY) {
+        decoder.reset(new ContentDecoder(content_encoding));
+    }
+    
+    if (chunked) {
+        state = State::CHUNK_SIZE;
+    } else if (content_length >= 0) {
+        body_remaining = (size_t)content_length;
+        state = State::BODY_LENGTH;
+        if (body_remaining == 0) {
+            end_body();
+        }
+    } else {
+        keep_alive = false;
+        state = State::BODY_UNTIL_CLOSE;
+    }
+}
+
+bool HttpResponseParser::handle_chunk_size_line() {
+    // Hex size, optionally followed by ";extensions"
+    size_t size = 0;
+    size_t digits = 0;
+    for (char c : line) {
+        int nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else break;
+        
+        if (++digits > 7) {
+            return false;  // Larger than anything we can hold
+        }
+        size = (size << 4) | nibble;
+    }
+    if (digits == 0) {
+        return false;
+    }
+    
+    body_remaining = size;
+    state = (size == 0) ? State::CHUNK_TRAILER : State::CHUNK_DATA;
+    return true;
+}
+
+void HttpResponseParser::end_body() {
+    // A coded body must also have reached the end of its compressed stream
+    if (decoder && !decoder->is_finished()) {
+        state = State::ERROR;
+    } else {
+        state = State::DONE;
+    }
+}
+
+bool HttpResponseParser::deliver(const char* data, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    if (decoder) {
+        return decoder->feed(std::string_view(data, len), body_callback);
+    }
+    if (body_callback) {
+        body_callback(std::string_view(data, len));
+    }
+    return true;
+}
+
+size_t HttpResponseParser::feed(std::string_view input) {
+    const char* data = input.data();
+    size_t len = input.size();
+    size_t pos = 0;
+    
+    while (pos < len && state != State::DONE && state != State::ERROR) {
+        switch (state) {
+            case State::STATUS_LINE:
+                if (collect_line(data[pos++])) {
+                    state = handle_status_line() ? State::HEADER_LINE : State::ERROR;
+                    line.clear();
+                }
+                break;
+                
+            case State::HEADER_LINE:
+                if (collect_line(data[pos++])) {
+                    if (line.empty()) {
+                        // Blank line ends the header block
+                        if (status_code >= 100 && status_code < 200) {
+                            state = State::STATUS_LINE;  // Interim response, real one follows
+                        } else {
+                            begin_body();
+                        }
+                    } else {
+                        handle_header_line();
+                    }
+                    line.clear();
+                }
+                break;
+                
+            case State::BODY_LENGTH:
+            case State::CHUNK_DATA: {
+                size_t count = std::min(len - pos, body_remaining);
+                bool ok = deliver(data + pos, count);
+                pos += count;
+                body_remaining -= count;
+                if (!ok) {
+                    state = State::ERROR;
+                } else if (body_remaining == 0) {
+                    if (state == State::BODY_LENGTH) {
+                        end_body();
+                    } else {
+                        state = State::CHUNK_DATA_END;
+                    }
+                }
+                break;
+            }
+                
+            case State::BODY_UNTIL_CLOSE:
+                if (!deliver(data + pos, len - pos)) {
+                    state = State::ERROR;
+                }
+                pos = len;
+                break;
+                
+            case State::CHUNK_SIZE:
+                if (collect_line(data[pos++])) {
+                    if (!handle_chunk_size_line()) {
+                        state = State::ERROR;
+                    }
+                    line.clear();
+                }
+                break;
+                
+            case State::CHUNK_DATA_END:
+                if (collect_line(data[pos++])) {
+                    state = line.empty() ? State::CHUNK_SIZE : State::ERROR;
+                    line.clear();
+                }
+                break;
+                
+            case State::CHUNK_TRAILER:
+                // Trailer headers are ignored; a blank line ends the message
+                if (collect_line(data[pos++])) {
+                    if (line.empty()) {
+                        end_body();
+                    }
+                    line.clear();
+                }
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    return pos;
+}
+
+void HttpResponseParser::finish() {
+    if (state == State::BODY_UNTIL_CLOSE) {
+        end_body();
+    } else if (state != State::DONE) {
+        state = State::ERROR;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "content_decoder.h"
+
+// Longest status/header/chunk-size line kept; longer lines are truncated
+#define HTTP_PARSER_MAX_LINE 256
+
+// Incremental HTTP/1.1 response parser
+// Handles the status line, headers, Content-Length, chunked transfer coding
+// and read-until-close bodies. Body bytes are passed to the consumer as they
+// arrive; the parser itself only keeps one header line in memory. gzip and
+// deflate Content-Encoding are inflated on the fly.
+class HttpResponseParser {
+public:
+    using HeaderCallback = std::function<void(const std::string& name, const std::string& value)>;
+    using BodyCallback = std::function<void(std::string_view chunk)>;
+    
+    HttpResponseParser();
+    
+    // Prepare for a new response (keeps the callbacks)
+    void reset();
+    
+    void set_header_callback(HeaderCallback callback) { header_callback = callback; }
+    void set_body_callback(BodyCallback callback) { body_callback = callback; }
+    
+    // Coded bodies are only inflated while this holds the decoder slot
+    // (ContentDecoder::claim_slot); otherwise they are an error. Kept by reset().
+    void set_decoding_allowed(bool allowed) { decoding_allowed = allowed; }
+    
+    // Consume response bytes. Returns how many bytes belong to this response;
+    // anything after that is the start of the next one on the connection.
+    size_t feed(std::string_view data);
+    
+    // The peer closed the connection. Completes read-until-close bodies.
+    void finish();
+    
+    bool is_complete() const { return state == State::DONE; }
+    bool has_error() const { return state == State::ERROR; }
+    bool headers_complete() const { return state > State::HEADER_LINE && state != State::ERROR; }
+    
+    int get_status_code() const { return status_code; }
+    bool is_success() const { return is_complete() && status_code >= 200 && status_code < 300; }
+    bool is_chunked() const { return chunked; }
+    bool is_keep_alive() const { return keep_alive; }
+    long get_content_length() const { return content_length; }
+    
+    // Body size before and after Content-Encoding was undone
+    bool is_compressed() const { return decoder != nullptr; }
+    size_t get_encoded_bytes() const { return decoder ? decoder->get_encoded_bytes() : 0; }
+    size_t get_decoded_bytes() const { return decoder ? decoder->get_decoded_bytes() : 0; }
+    
+private:
+    enum class State : uint8_t {
+        STATUS_LINE,
+        HEADER_LINE,
+        BODY_LENGTH,        // Content-Length delimited
+        BODY_UNTIL_CLOSE,   // No length given - body ends at connection close
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,     // CRLF after chunk data
+        CHUNK_TRAILER,
+        DONE,
+        ERROR
+    };
+    
+    HeaderCallback header_callback;
+    BodyCallback body_callback;
+    State state;
+    std::string line;
+    int status_code;
+    long content_length;
+    size_t body_remaining;
+    bool chunked;
+    bool keep_alive;
+    bool decoding_allowed;
+    ContentDecoder::Encoding content_encoding;
+    std::unique_ptr<ContentDecoder> decoder;  // Only while a coded body is read
+    
+    // Returns true once a full line is in `line` (CRLF stripped)
+    bool collect_line(char c);
+    bool handle_status_line();
+    void handle_header_line();
+    void begin_body();
+    void end_body();
+    bool handle_chunk_size_line();
+    bool deliver(const char* data, size_t len);
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "request_queue.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+class TransportConnection;
+
+// Events of one transport connection, delivered to whoever opened it
+class TransportListener {
+public:
+    virtual ~TransportListener() {}
+    
+    // The byte stream is ready (TCP connected, TLS handshake done)
+    virtual void on_connected(TransportConnection* link) = 0;
+    
+    // Bytes from the peer - the view is only valid during the call
+    virtual void on_data(TransportConnection* link, std::string_view data) = 0;
+    
+    // Last event: the peer closed (NONE) or the connection failed
+    // (DNS_FAILED, CONNECT_FAILED, CONNECTION_LOST, OUT_OF_MEMORY).
+    // The connection is freed once this returns.
+    virtual void on_closed(TransportConnection* link, HttpError error) = 0;
+};
+
+// One byte stream to a host
+class TransportConnection {
+public:
+    virtual ~TransportConnection() {}
+    
+    // Start resolving and connecting. Listener events may arrive before
+    // this returns.
+    virtual void connect(TransportListener* listener) = 0;
+    
+    // Queue bytes for sending. Returns NONE, OUT_OF_MEMORY or CONNECTION_LOST.
+    virtual HttpError write(std::string_view data) = 0;
+    
+    // Tear the connection down. No events follow and the connection is
+    // freed - also safe from inside a listener event.
+    virtual void close(bool abort) = 0;
+};
+
+// Transport for one URL scheme - plain TCP, TLS, or a host socket backend
+class HttpTransport {
+public:
+    virtual ~HttpTransport() {}
+    
+    // Port used when the URL does not give one
+    virtual uint16_t default_port() const = 0;
+    
+    // New, unconnected connection to host:port
+    virtual TransportConnection* create(const std::string& host, uint16_t port) = 0;
+    
+    // Housekeeping (call in main loop)
+    virtual void process(uint32_t now_ms) { (void)now_ms; }
+};
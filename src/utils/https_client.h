@@ -1,47 +1,73 @@
 #pragma once
 
 #include "pico/stdlib.h"
-#include "pico/cyw43_arch.h"
 
 // Prevent PNG zutil.h macro conflict with lwIP
 #ifdef local
 #undef local
 #endif
 
-#include "lwip/altcp_tls.h"
-#include "lwip/altcp.h"
-#include "lwip/dns.h"
+#include "http_client.h"
+#include "altcp_transport.h"
+#include "network_manager.h"
 #include <string>
 #include <functional>
 
+// Each TLS connection needs two record buffers plus handshake state from the
+// heap, and one lwIP TCP PCB - two open at once is what the Pico 2 W can afford
+#define HTTPS_MAX_CONNECTIONS 2
+
+// Requests sent back-to-back on one keep-alive connection before waiting
+#define HTTPS_MAX_PIPELINE 4
+
+// HTTPS (and plain HTTP) client for the apps
+// The HTTP work is done by HttpClient over lwIP's TLS and TCP transports.
+// The WiFi link belongs to the NetworkManager; requests fail fast while it is
+// down and in-flight ones are failed when it drops. The NetworkManager's
+// process() also runs this client's deadlines, pool and transports, so
+// requests progress while the app that made them is off screen.
 class HttpsClient {
 public:
-    HttpsClient();
-    ~HttpsClient();
+    // Streaming callbacks: body bytes are delivered as each buffer arrives
+    // Chunks are views into the receive buffers, valid only during the call
+    using BodyCallback = HttpClient::BodyCallback;
+    using CompleteCallback = HttpClient::CompleteCallback;
+    using ErrorCallback = HttpClient::ErrorCallback;
     
-    // Initialize WiFi and HTTP client
-    bool init(const char* ssid, const char* password);
+    explicit HttpsClient(NetworkManager& network);
+    ~HttpsClient();
     
     // Make HTTPS GET request (non-blocking)
-    bool get(const std::string& url, std::function<void(const std::string&)> callback);
+    // The whole body is collected into one string - only for small responses
+    uint32_t get(const std::string& url, std::function<void(const std::string&)> callback,
+                 const RequestOptions& options = RequestOptions());
     
-    // Check if WiFi is connected
-    bool is_connected();
+    // Make HTTPS GET request and stream the body without buffering it.
+    // Requests are queued; each one gets its own callbacks. on_error (optional)
+    // reports why a request failed before on_complete(false) is called.
+    // Requests to the same host share one keep-alive connection and are
+    // pipelined on it. Returns a request id for cancel(), or 0 if rejected (not
+    // connected) - on_error and on_complete(false) have then already run.
+    uint32_t get_stream(const std::string& url, BodyCallback on_body, CompleteCallback on_complete,
+                        const RequestOptions& options = RequestOptions(), ErrorCallback on_error = nullptr);
     
-    // Process pending network operations (call in main loop)
-    void process();
+    // Cancel a queued or in-flight request; its callbacks will not be called
+    bool cancel(uint32_t request_id);
+    
+    // Close all pooled connections (e.g. before the link goes down)
+    void close_idle_connections();
+    
+    // Handshake metrics, for comparing TLS profiles on the device
+    using HandshakeStats = TlsTransport::HandshakeStats;
+    const HandshakeStats& get_handshake_stats() const { return tls_transport.get_handshake_stats(); }
+    
+    // Check if WiFi is connected
+    bool is_connected() const;
     
 private:
-    bool wifi_connected;
-    struct altcp_pcb* tls_pcb;
-    struct altcp_tls_config* tls_config;
-    std::function<void(const std::string&)> response_callback;
-    std::string response_buffer;
-    
-    // Internal callback functions
-    static err_t tls_connected_callback(void* arg, struct altcp_pcb* pcb, err_t err);
-    static err_t tls_recv_callback(void* arg, struct altcp_pcb* pcb, struct pbuf* p, err_t err);
-    static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg);
-    
-    void parse_url(const std::string& url, std::string& host, std::string& path);
-};
\ No newline at end of file
+    NetworkManager& network;
+    uint32_t state_listener;
+    TlsTransport tls_transport;
+    TcpTransport tcp_transport;
+    HttpClient http;
+};
@@ -2,6 +2,42 @@
 #include <algorithm>
 #include <sstream>
 
+// Manual number parsing shared by both parsers (no std::stod on the Pico)
+static double parse_number_text(const std::string& value) {
+    if (value.empty()) {
+        return 0.0;
+    }
+    
+    double result = 0.0;
+    double sign = 1.0;
+    size_t pos = 0;
+    
+    // Handle negative numbers
+    if (value[0] == '-') {
+        sign = -1.0;
+        pos = 1;
+    }
+    
+    // Parse integer part
+    while (pos < value.length() && value[pos] >= '0' && value[pos] <= '9') {
+        result = result * 10.0 + (value[pos] - '0');
+        pos++;
+    }
+    
+    // Parse decimal part
+    if (pos < value.length() && value[pos] == '.') {
+        pos++;
+        double fraction = 0.1;
+        while (pos < value.length() && value[pos] >= '0' && value[pos] <= '9') {
+            result += (value[pos] - '0') * fraction;
+            fraction *= 0.1;
+            pos++;
+        }
+    }
+    
+    return result * sign;
+}
+
 JsonParser::JsonParser(const std::string& json_str) : json_data(json_str) {
     // Remove whitespace for easier parsing
     json_data.erase(std::remove_if(json_data.begin(), json_data.end(), ::isspace), json_data.end());
@@ -87,39 +123,7 @@ std::string JsonParser::extractString(const std::string& value) const {
 }
 
 double JsonParser::extractNumber(const std::string& value) const {
-    if (value.empty()) {
-        return 0.0;
-    }
-    
-    // Simple manual parsing instead of std::stod
-    double result = 0.0;
-    double sign = 1.0;
-    size_t pos = 0;
-    
-    // Handle negative numbers
-    if (value[0] == '-') {
-        sign = -1.0;
-        pos = 1;
-    }
-    
-    // Parse integer part
-    while (pos < value.length() && value[pos] >= '0' && value[pos] <= '9') {
-        result = result * 10.0 + (value[pos] - '0');
-        pos++;
-    }
-    
-    // Parse decimal part
-    if (pos < value.length() && value[pos] == '.') {
-        pos++;
-        double fraction = 0.1;
-        while (pos < value.length() && value[pos] >= '0' && value[pos] <= '9') {
-            result += (value[pos] - '0') * fraction;
-            fraction *= 0.1;
-            pos++;
-        }
-    }
-    
-    return result * sign;
+    return parse_number_text(value);
 }
 
 std::string JsonParser::getString(const std::string& path) const {
@@ -172,4 +176,235 @@ double JsonParser::getArrayNumber(const std::string& path, int index) const {
 
 bool JsonParser::hasKey(const std::string& path) const {
     return !getNestedValue(path).empty();
-}
\ No newline at end of file
+}
+
+// ---------------------------------------------------------------------------
+// JsonStreamParser
+// ---------------------------------------------------------------------------
+
+JsonStreamParser::JsonStreamParser(ValueCallback callback) : value_callback(callback) {
+    path.reserve(64);
+    token.reserve(JSON_STREAM_MAX_TOKEN);
+    reset();
+}
+
+void JsonStreamParser::reset() {
+    state = State::VALUE;
+    in_key = false;
+    unicode_remaining = 0;
+    depth = 0;
+    path.clear();
+    token.clear();
+}
+
+double JsonStreamParser::to_number(const std::string& value) {
+    return parse_number_text(value);
+}
+
+bool JsonStreamParser::feed(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (!process_char(data[i])) {
+            state = State::ERROR;
+            return false;
+        }
+    }
+    return state != State::ERROR;
+}
+
+bool JsonStreamParser::finish() {
+    // A bare top-level number has no terminator, flush it here
+    if (state == State::LITERAL && depth == 0) {
+        if (value_callback) {
+            value_callback(path, token);
+        }
+        state = State::DONE;
+    }
+    return state == State::DONE;
+}
+
+void JsonStreamParser::append_token(char c) {
+    // Over-long strings are truncated rather than growing the buffer
+    if (token.length() < JSON_STREAM_MAX_TOKEN) {
+        token += c;
+    }
+}
+
+bool JsonStreamParser::push_frame(bool is_array) {
+    if (depth >= JSON_STREAM_MAX_DEPTH) {
+        return false;
+    }
+    stack[depth].is_array = is_array;
+    stack[depth].index = 0;
+    stack[depth].path_len = (uint16_t)path.length();
+    depth++;
+    return true;
+}
+
+void JsonStreamParser::set_array_element_path() {
+    Frame& frame = stack[depth - 1];
+    path.resize(frame.path_len);
+    path += '[';
+    path += std::to_string(frame.index);
+    path += ']';
+}
+
+void JsonStreamParser::end_value() {
+    state = (depth == 0) ? State::DONE : State::AFTER_VALUE;
+}
+
+static bool is_json_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_literal_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+}
+
+bool JsonStreamParser::process_char(char c) {
+    switch (state) {
+        case State::VALUE:
+            if (is_json_space(c)) return true;
+            if (c == '{') {
+                if (!push_frame(false)) return false;
+                state = State::OBJECT_KEY_OR_END;
+            } else if (c == '[') {
+                if (!push_frame(true)) return false;
+                state = State::ARRAY_VALUE_OR_END;
+            } else if (c == '"') {
+                token.clear();
+                in_key = false;
+                state = State::STRING;
+            } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                token.clear();
+                token += c;
+                state = State::LITERAL;
+            } else {
+                return false;
+            }
+            return true;
+            
+        case State::ARRAY_VALUE_OR_END:
+            if (is_json_space(c)) return true;
+            if (c == ']') {
+                depth--;
+                path.resize(stack[depth].path_len);
+                end_value();
+                return true;
+            }
+            set_array_element_path();
+            state = State::VALUE;
+            return process_char(c);
+            
+        case State::OBJECT_KEY_OR_END:
+            if (is_json_space(c)) return true;
+            if (c == '}') {
+                depth--;
+                path.resize(stack[depth].path_len);
+                end_value();
+                return true;
+            }
+            [[fallthrough]];
+        case State::OBJECT_KEY:
+            if (is_json_space(c)) return true;
+            if (c != '"') return false;
+            token.clear();
+            in_key = true;
+            state = State::STRING;
+            return true;
+            
+        case State::STRING:
+            if (c == '\\') {
+                state = State::STRING_ESCAPE;
+            } else if (c == '"') {
+                if (in_key) {
+                    // Key complete - build the path of the value that follows
+                    path.resize(stack[depth - 1].path_len);
+                    if (!path.empty()) {
+                        path += '.';
+                    }
+                    path += token;
+                    state = State::COLON;
+                } else {
+                    if (value_callback) {
+                        value_callback(path, token);
+                    }
+                    end_value();
+                }
+            } else {
+                append_token(c);
+            }
+            return true;
+            
+        case State::STRING_ESCAPE:
+            state = State::STRING;
+            switch (c) {
+                case 'n': append_token('\n'); break;
+                case 't': append_token('\t'); break;
+                case 'r': append_token('\r'); break;
+                case 'b': append_token('\b'); break;
+                case 'f': append_token('\f'); break;
+                case 'u':
+                    // Display font is ASCII only - substitute a placeholder
+                    append_token('?');
+                    unicode_remaining = 4;
+                    state = State::STRING_UNICODE;
+                    break;
+                default: append_token(c); break;
+            }
+            return true;
+            
+        case State::STRING_UNICODE:
+            if (--unicode_remaining == 0) {
+                state = State::STRING;
+            }
+            return true;
+            
+        case State::COLON:
+            if (is_json_space(c)) return true;
+            if (c != ':') return false;
+            state = State::VALUE;
+            return true;
+            
+        case State::LITERAL:
+            if (is_literal_char(c)) {
+                append_token(c);
+                return true;
+            }
+            if (value_callback) {
+                value_callback(path, token);
+            }
+            end_value();
+            // The terminating character belongs to the enclosing container
+            return process_char(c);
+            
+        case State::AFTER_VALUE:
+            if (is_json_space(c)) return true;
+            if (c == ',') {
+                Frame& frame = stack[depth - 1];
+                if (frame.is_array) {
+                    frame.index++;
+                    set_array_element_path();
+                    state = State::VALUE;
+                } else {
+                    state = State::OBJECT_KEY;
+                }
+                return true;
+            }
+            if ((c == '}' && !stack[depth - 1].is_array) || (c == ']' && stack[depth - 1].is_array)) {
+                depth--;
+                path.resize(stack[depth].path_len);
+                end_value();
+                return true;
+            }
+            return false;
+            
+        case State::DONE:
+            // Only trailing whitespace is allowed after the document
+            return is_json_space(c);
+            
+        case State::ERROR:
+        default:
+            return false;
+    }
+}
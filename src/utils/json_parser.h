@@ -1,7 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
 
 // Simple JSON parser for weather data
 // Supports basic key-value extraction for our specific use case
@@ -32,4 +36,74 @@ private:
     std::string extractString(const std::string& value) const;
     double extractNumber(const std::string& value) const;
     std::string getNestedValue(const std::string& path) const;
-};
\ No newline at end of file
+};
+
+// Incremental (SAX-style) JSON parser for responses that arrive in pieces.
+// Bytes can be fed as each network buffer arrives; parsing state survives
+// across chunk boundaries, so the full document is never held in memory.
+// Every scalar value is reported with its dotted path, e.g. "main.temp" or
+// "weather[0].icon". Memory use is bounded by JSON_STREAM_MAX_DEPTH and
+// JSON_STREAM_MAX_TOKEN regardless of the document size.
+#define JSON_STREAM_MAX_DEPTH 12
+#define JSON_STREAM_MAX_TOKEN 96
+
+class JsonStreamParser {
+public:
+    // Called for every string, number, boolean or null value
+    using ValueCallback = std::function<void(const std::string& path, const std::string& value)>;
+    
+    explicit JsonStreamParser(ValueCallback callback);
+    
+    // Prepare for a new document (keeps the callback)
+    void reset();
+    
+    // Consume the next chunk of the document. Returns false once an error is hit.
+    bool feed(const char* data, size_t len);
+    bool feed(std::string_view chunk) { return feed(chunk.data(), chunk.size()); }
+    
+    // Signal end of input (flushes a trailing top-level number)
+    bool finish();
+    
+    bool is_complete() const { return state == State::DONE; }
+    bool has_error() const { return state == State::ERROR; }
+    
+    // Convert a reported value to a number (same rules as JsonParser)
+    static double to_number(const std::string& value);
+    
+private:
+    enum class State : uint8_t {
+        VALUE,
+        OBJECT_KEY_OR_END,
+        OBJECT_KEY,
+        ARRAY_VALUE_OR_END,
+        STRING,
+        STRING_ESCAPE,
+        STRING_UNICODE,
+        COLON,
+        LITERAL,
+        AFTER_VALUE,
+        DONE,
+        ERROR
+    };
+    
+    struct Frame {
+        bool is_array;
+        uint16_t index;
+        uint16_t path_len;  // Length of the container's own path
+    };
+    
+    ValueCallback value_callback;
+    State state;
+    bool in_key;
+    uint8_t unicode_remaining;
+    uint8_t depth;
+    Frame stack[JSON_STREAM_MAX_DEPTH];
+    std::string path;
+    std::string token;
+    
+    bool process_char(char c);
+    bool push_frame(bool is_array);
+    void end_value();
+    void append_token(char c);
+    void set_array_element_path();
+};
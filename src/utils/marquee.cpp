@@ -0,0 +1,83 @@
+#include "marquee.h"
+#include "text_renderer.h"
+
+Marquee::Marquee(int x, int y, int width, RotationMode rotation)
+    : x(x)
+    , y(y)
+    , width(width)
+    , rotation(rotation)
+    , r(255)
+    , g(255)
+    , b(255)
+    , speed_pps(MARQUEE_DEFAULT_SPEED_PPS)
+    , text_width(0)
+    , offset_fp(0)
+    , hold_ms(MARQUEE_HOLD_MS) {
+}
+
+void Marquee::set_text(const std::string& text) {
+    if (text == this->text && !columns.empty()) {
+        return;
+    }
+    this->text = text;
+    text_width = rasterize_text_columns(text, columns);
+    offset_fp = 0;
+    hold_ms = MARQUEE_HOLD_MS;
+}
+
+void Marquee::set_color(uint8_t r, uint8_t g, uint8_t b) {
+    this->r = r;
+    this->g = g;
+    this->b = b;
+}
+
+void Marquee::reset() {
+    offset_fp = 0;
+    hold_ms = MARQUEE_HOLD_MS;
+}
+
+bool Marquee::update(uint32_t dt_ms) {
+    if (!is_scrolling()) {
+        return false;
+    }
+    
+    if (hold_ms > 0) {
+        if (dt_ms < hold_ms) {
+            hold_ms -= dt_ms;
+            return false;
+        }
+        dt_ms -= hold_ms;
+        hold_ms = 0;
+    }
+    
+    uint32_t period_fp = (uint32_t)(text_width + MARQUEE_GAP_PX) << 16;
+    uint32_t previous = offset_fp >> 16;
+    offset_fp += (uint32_t)(((uint64_t)speed_pps * dt_ms << 16) / 1000);
+    if (offset_fp >= period_fp) {
+        // Back at the start - hold there again
+        offset_fp = 0;
+        hold_ms = MARQUEE_HOLD_MS;
+    }
+    return (offset_fp >> 16) != previous;
+}
+
+void Marquee::draw(RenderContext& ctx) const {
+    int period = text_width + MARQUEE_GAP_PX;
+    int column = is_scrolling() ? (int)(offset_fp >> 16) : 0;
+    int visible = is_scrolling() ? width : text_width;
+    
+    for (int i = 0; i < visible; i++, column++) {
+        if (column >= period) {
+            column -= period;
+        }
+        if (column >= text_width) {
+            continue;    // Gap
+        }
+        uint8_t bits = columns[column];
+        for (int row = 0; bits != 0; row++, bits >>= 1) {
+            if (bits & 1) {
+                draw_pixel_mode(ctx, x + i, y + row, r, g, b, rotation);
+            }
+        }
+    }
+}
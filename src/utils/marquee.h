@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../core/common.hpp"
+
+// Blank columns between the end of the text and its next pass
+#define MARQUEE_GAP_PX 8
+
+// Default scroll speed
+#define MARQUEE_DEFAULT_SPEED_PPS 12
+
+// The window holds still this long at the start of every pass
+#define MARQUEE_HOLD_MS 1500
+
+// Scrolling text in a fixed window, for strings wider than their space
+// The text is rasterised once (when it changes) into a strip of column
+// bitmasks; every frame then only copies a window of that strip to the
+// screen at the current offset. Text that fits is drawn still. Each
+// marquee keeps its own position, so a screen can show several at once.
+class Marquee {
+public:
+    Marquee(int x, int y, int width, RotationMode rotation = RotationMode::HORIZONTAL_UPSIDE_DOWN);
+    
+    // Change the text; same text keeps the current scroll position
+    void set_text(const std::string& text);
+    void set_color(uint8_t r, uint8_t g, uint8_t b);
+    void set_speed(uint16_t pixels_per_second) { speed_pps = pixels_per_second; }
+    
+    // Advance by dt_ms. Returns true if the visible window moved.
+    bool update(uint32_t dt_ms);
+    
+    // Back to the start of a pass, holding there
+    void reset();
+    
+    // Copy the visible window into ctx
+    void draw(RenderContext& ctx) const;
+    
+    bool is_scrolling() const { return text_width > width; }
+    const std::string& get_text() const { return text; }
+    
+private:
+    int x;
+    int y;
+    int width;
+    RotationMode rotation;
+    uint8_t r, g, b;
+    uint16_t speed_pps;
+    
+    std::string text;
+    std::vector<uint8_t> columns;    // Bit n set = row n lit
+    int text_width;
+    uint32_t offset_fp;              // Scroll offset in 16.16 pixels
+    uint32_t hold_ms;                // Time left before the pass starts moving
+};
@@ -6,25 +6,34 @@
 #endif
 
 #include "pico/cyw43_arch.h"
-#include "lwip/tcp.h"
-#include "lwip/dns.h" 
-#include "lwip/pbuf.h"
-#include <cstring>
+#include "lwip/netif.h"
+#include "lwip/dhcp.h"
 #include <algorithm>
+#include <cstring>
 
 // Connection retry settings
 #define WIFI_CONNECT_TIMEOUT_MS 30000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 4000   // Directed join + INIT-REBOOT should take ~1s
 #define RETRY_BASE_DELAY_MS 1000
 #define RETRY_MAX_DELAY_MS 30000
 
+static uint32_t now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
 NetworkManager::NetworkManager() 
     : state(NetworkState::DISCONNECTED)
     , wifi_initialized(false)
+    , auto_reconnect(false)
     , last_connection_attempt(0)
     , connection_retry_delay(RETRY_BASE_DELAY_MS)
-    , tcp_pcb(nullptr)
+    , fast_connect_attempt(false)
+    , next_listener_id(1)
+    , tcp_transport(dns_cache)
+    , http(HTTP_MAX_CONCURRENT, 1)
 {
     status_message = "Not initialized";
+    http.add_transport("http", &tcp_transport);
 }
 
 NetworkManager::~NetworkManager() {
@@ -43,83 +52,186 @@ bool NetworkManager::init_wifi(const char* ssid, const char* password) {
     
     // Initialize CYW43 WiFi chip
     if (cyw43_arch_init()) {
-        status_message = "CYW43 init failed";
-        state = NetworkState::ERROR;
+        printf("NetworkManager: CYW43 init failed\n");
+        set_state(NetworkState::ERROR, "CYW43 init failed");
         return false;
     }
     
     wifi_initialized = true;
     wifi_ssid = ssid;
+    wifi_password = password;
+    auto_reconnect = true;
     
     cyw43_arch_enable_sta_mode();
+    connect_cache.load_from_flash();
     
-    status_message = "WiFi initialized";
-    state = NetworkState::DISCONNECTED;
+    printf("NetworkManager: WiFi initialized for SSID: %s\n", ssid);
     
-    printf("NetworkManager: WiFi initialized for SSID: %s\\n", ssid);
+    // The join runs in the background; process() follows it
+    attempt_wifi_connection();
+    return true;
+}
+
+bool NetworkManager::attempt_wifi_connection() {
+    last_connection_attempt = now_ms();
     
-    // Start connection attempt
-    state = NetworkState::CONNECTING;
-    last_connection_attempt = to_ms_since_boot(get_absolute_time());
+    const WifiConnectCache::Record* cached = connect_cache.lookup(wifi_ssid);
+    if (cached && start_fast_connect(*cached)) {
+        set_state(NetworkState::CONNECTING, "Reconnecting to WiFi...");
+        return true;
+    }
     
-    // Attempt connection (non-blocking)
-    int result = cyw43_arch_wifi_connect_async(ssid, password, CYW43_AUTH_WPA2_AES_PSK);
+    // Scan every channel for the SSID
+    fast_connect_attempt = false;
+    int result = cyw43_arch_wifi_connect_async(wifi_ssid.c_str(), wifi_password.c_str(), CYW43_AUTH_WPA2_AES_PSK);
+    if (result != 0) {
+        printf("NetworkManager: WiFi connect failed to start: %d\n", result);
+        set_state(NetworkState::ERROR, "WiFi connect failed");
+        return false;
+    }
+    
+    set_state(NetworkState::CONNECTING, "Connecting to WiFi...");
+    return true;
+}
+
+bool NetworkManager::start_fast_connect(const WifiConnectCache::Record& cached) {
+    cyw43_arch_lwip_begin();
+    
+    // Ask DHCP for the previous address instead of discovering a new one.
+    // After a link drop lwIP is still bound and does this by itself; after a
+    // reboot the client is idle until the link comes up, so point it there.
+    struct dhcp* dhcp = netif_dhcp_data(&cyw43_state.netif[CYW43_ITF_STA]);
+    if (dhcp && dhcp->state == DHCP_STATE_INIT && cached.ip != 0) {
+        ip4_addr_set_u32(&dhcp->offered_ip_addr, cached.ip);
+        dhcp->state = DHCP_STATE_REBOOTING;
+    }
+    
+    // Join the known access point on its channel - no scan
+    int result = cyw43_wifi_join(&cyw43_state, strlen(cached.ssid), (const uint8_t*)cached.ssid,
+                                 wifi_password.length(), (const uint8_t*)wifi_password.c_str(),
+                                 CYW43_AUTH_WPA2_AES_PSK, cached.bssid, cached.channel);
+    cyw43_arch_lwip_end();
     
     if (result != 0) {
-        status_message = "WiFi connect failed";
-        state = NetworkState::ERROR;
+        printf("NetworkManager: Fast connect failed to start: %d\n", result);
+        connect_cache.forget();
         return false;
     }
     
-    status_message = "Connecting to WiFi...";
+    fast_connect_attempt = true;
+    printf("NetworkManager: Fast connect to %02x:%02x:%02x:%02x:%02x:%02x on channel %lu\n",
+           cached.bssid[0], cached.bssid[1], cached.bssid[2], cached.bssid[3], cached.bssid[4], cached.bssid[5],
+           (unsigned long)cached.channel);
     return true;
 }
 
+void NetworkManager::remember_association() {
+    uint8_t bssid[6];
+    if (cyw43_wifi_get_bssid(&cyw43_state, bssid) != 0) {
+        return;
+    }
+    
+    // The channel the radio is on now - WLC_GET_CHANNEL returns {hw, target, scan}
+    uint32_t channel = CYW43_CHANNEL_NONE;
+#ifdef CYW43_IOCTL_GET_CHANNEL
+    uint32_t channel_info[3] = {0, 0, 0};
+    if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channel_info), (uint8_t*)channel_info,
+                    CYW43_ITF_STA) == 0 && channel_info[0] != 0) {
+        channel = channel_info[0];
+    }
+#endif
+    
+    uint32_t ip = netif_default ? ip4_addr_get_u32(netif_ip4_addr(netif_default)) : 0;
+    connect_cache.store(wifi_ssid, bssid, channel, ip);
+}
+
+void NetworkManager::set_state(NetworkState new_state, const char* message) {
+    status_message = message;
+    if (new_state == state) {
+        return;
+    }
+    state = new_state;
+    
+    // Listeners may add or remove listeners - walk a copy
+    std::vector<StateListener> notify = listeners;
+    for (const StateListener& listener : notify) {
+        listener.callback(new_state);
+    }
+}
+
+uint32_t NetworkManager::add_state_listener(StateCallback callback) {
+    uint32_t id = next_listener_id++;
+    listeners.push_back({id, callback});
+    return id;
+}
+
+void NetworkManager::remove_state_listener(uint32_t listener_id) {
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [listener_id](const StateListener& listener) {
+                                       return listener.id == listener_id;
+                                   }),
+                    listeners.end());
+}
+
 void NetworkManager::update_connection_state() {
     if (!wifi_initialized) {
         return;
     }
     
-    uint32_t now = to_ms_since_boot(get_absolute_time());
-    int link_status = cyw43_wifi_link_status(&cyw43_state, CYW43_ITF_STA);
+    uint32_t now = now_ms();
+    // Up only once DHCP has given us an address
+    int link_status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
     
     switch (state) {
         case NetworkState::CONNECTING:
             if (link_status == CYW43_LINK_UP) {
-                state = NetworkState::CONNECTED;
-                status_message = "WiFi connected";
                 connection_retry_delay = RETRY_BASE_DELAY_MS; // Reset retry delay
-                printf("NetworkManager: WiFi connected successfully\\n");
-            } else if (link_status == CYW43_LINK_FAIL || link_status == CYW43_LINK_NONET) {
-                state = NetworkState::ERROR;
-                status_message = "WiFi connection failed";
-                printf("NetworkManager: WiFi connection failed\\n");
+                printf("NetworkManager: WiFi connected in %lu ms (%s), IP %s\n",
+                       (unsigned long)(now - last_connection_attempt),
+                       fast_connect_attempt ? "fast connect" : "full scan", get_ip_address().c_str());
+                set_state(NetworkState::CONNECTED, "WiFi connected");
+                remember_association();
+            } else if (fast_connect_attempt &&
+                       (link_status < 0 || (link_status != CYW43_LINK_JOIN && link_status != CYW43_LINK_NOIP &&
+                                            now - last_connection_attempt > WIFI_FAST_CONNECT_TIMEOUT_MS))) {
+                // Not associated: the access point moved or went away - scan for the SSID straight away.
+                // Once associated, a slow DHCP answer just runs into the normal timeout.
+                printf("NetworkManager: Fast connect failed (%d), scanning\n", link_status);
+                cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+                connect_cache.forget();
+                attempt_wifi_connection();
+            } else if (link_status == CYW43_LINK_FAIL || link_status == CYW43_LINK_NONET ||
+                       link_status == CYW43_LINK_BADAUTH) {
+                printf("NetworkManager: WiFi connection failed: %d\n", link_status);
+                set_state(NetworkState::ERROR, link_status == CYW43_LINK_BADAUTH ? "WiFi password rejected"
+                                                                                  : "WiFi connection failed");
             } else if (now - last_connection_attempt > WIFI_CONNECT_TIMEOUT_MS) {
-                state = NetworkState::ERROR;
-                status_message = "WiFi connection timeout";
-                printf("NetworkManager: WiFi connection timeout\\n");
+                printf("NetworkManager: WiFi connection timeout\n");
+                cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+                set_state(NetworkState::ERROR, "WiFi connection timeout");
             }
             break;
             
         case NetworkState::CONNECTED:
             if (link_status != CYW43_LINK_UP) {
-                state = NetworkState::DISCONNECTED;
-                status_message = "WiFi disconnected";
                 cleanup_tcp_connection();
-                printf("NetworkManager: WiFi disconnected\\n");
+                printf("NetworkManager: WiFi disconnected\n");
+                set_state(NetworkState::DISCONNECTED, "WiFi disconnected");
+                
+                // Rejoin the same access point straight away
+                connection_retry_delay = RETRY_BASE_DELAY_MS;
+                if (auto_reconnect) {
+                    attempt_wifi_connection();
+                }
             }
             break;
             
         case NetworkState::ERROR:
         case NetworkState::DISCONNECTED:
             // Auto-retry connection with exponential backoff
-            if (now - last_connection_attempt > connection_retry_delay) {
-                printf("NetworkManager: Attempting WiFi reconnection...\\n");
-                state = NetworkState::CONNECTING;
-                status_message = "Reconnecting to WiFi...";
-                last_connection_attempt = now;
-                
-                cyw43_arch_wifi_connect_async(wifi_ssid.c_str(), "", CYW43_AUTH_WPA2_AES_PSK);
+            if (auto_reconnect && now - last_connection_attempt > connection_retry_delay) {
+                printf("NetworkManager: Attempting WiFi reconnection...\n");
+                attempt_wifi_connection();
                 
                 // Exponential backoff
                 connection_retry_delay = std::min(connection_retry_delay * 2, (uint32_t)RETRY_MAX_DELAY_MS);
@@ -140,6 +252,14 @@ std::string NetworkManager::get_status_message() const {
     return status_message;
 }
 
+std::string NetworkManager::get_ip_address() const {
+    if (!is_connected() || netif_default == nullptr) {
+        return "";
+    }
+    char buffer[IP4ADDR_STRLEN_MAX];
+    return ip4addr_ntoa_r(netif_ip4_addr(netif_default), buffer, sizeof(buffer));
+}
+
 int NetworkManager::get_signal_strength() const {
     if (!wifi_initialized || !is_connected()) {
         return 0;
@@ -152,193 +272,66 @@ void NetworkManager::process() {
     if (wifi_initialized) {
         cyw43_arch_poll();
         update_connection_state();
+        
+        uint32_t now = now_ms();
+        http.process(now);
+        // By index: a callback may register or remove a client
+        for (size_t i = 0; i < http_clients.size(); i++) {
+            http_clients[i]->process(now);
+        }
+        dns_cache.process(now);
     }
 }
 
-void NetworkManager::disconnect() {
-    cleanup_tcp_connection();
-    
-    if (wifi_initialized && state != NetworkState::DISCONNECTED) {
-        cyw43_arch_disable_sta_mode();
-        state = NetworkState::DISCONNECTED;
-        status_message = "Disconnected";
+void NetworkManager::add_http_client(HttpClient* client) {
+    if (std::find(http_clients.begin(), http_clients.end(), client) == http_clients.end()) {
+        http_clients.push_back(client);
     }
 }
 
-void NetworkManager::cleanup_tcp_connection() {
-    if (tcp_pcb) {
-        tcp_close(tcp_pcb);
-        tcp_pcb = nullptr;
-    }
-    response_callback = nullptr;
-    response_buffer.clear();
+void NetworkManager::remove_http_client(HttpClient* client) {
+    http_clients.erase(std::remove(http_clients.begin(), http_clients.end(), client), http_clients.end());
 }
 
-void NetworkManager::parse_url(const std::string& url, std::string& host, std::string& path) {
-    // Simple URL parsing - assumes http:// or https://
-    size_t protocol_end = url.find("://");
-    if (protocol_end == std::string::npos) {
-        host = "";
-        path = "";
-        return;
-    }
-    
-    size_t host_start = protocol_end + 3;
-    size_t path_start = url.find('/', host_start);
+void NetworkManager::disconnect() {
+    cleanup_tcp_connection();
+    auto_reconnect = false;
     
-    if (path_start == std::string::npos) {
-        host = url.substr(host_start);
-        path = "/";
-    } else {
-        host = url.substr(host_start, path_start - host_start);
-        path = url.substr(path_start);
+    if (wifi_initialized && state != NetworkState::DISCONNECTED) {
+        cyw43_arch_disable_sta_mode();
+        set_state(NetworkState::DISCONNECTED, "Disconnected");
     }
 }
 
-struct http_request_data {
-    NetworkManager* manager;
-    std::string host;
-    std::string path;
-};
-
-void NetworkManager::dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg) {
-    http_request_data* req_data = (http_request_data*)arg;
-    
-    if (ipaddr == nullptr) {
-        printf("NetworkManager: DNS lookup failed for %s\\n", name);
-        delete req_data;
-        return;
-    }
-    
-    // Create TCP connection
-    struct tcp_pcb* pcb = tcp_new();
-    if (pcb == nullptr) {
-        printf("NetworkManager: Failed to create TCP PCB\\n");
-        delete req_data;
-        return;
-    }
-    
-    req_data->manager->tcp_pcb = pcb;
-    tcp_arg(pcb, req_data);
-    
-    err_t err = tcp_connect(pcb, ipaddr, 80, tcp_connected_callback);
-    if (err != ERR_OK) {
-        printf("NetworkManager: TCP connect failed: %d\\n", err);
-        tcp_close(pcb);
-        req_data->manager->tcp_pcb = nullptr;
-        delete req_data;
-    }
+void NetworkManager::cleanup_tcp_connection() {
+    // Fail everything in flight - the link is gone
+    http.fail_all(HttpError::NOT_CONNECTED);
 }
 
-signed char NetworkManager::tcp_connected_callback(void* arg, struct tcp_pcb* pcb, signed char err) {
-    http_request_data* req_data = (http_request_data*)arg;
-    
-    if (err != ERR_OK) {
-        printf("NetworkManager: TCP connection failed: %d\\n", err);
-        delete req_data;
-        return err;
-    }
-    
-    // Build HTTP GET request
-    std::string request = "GET " + req_data->path + " HTTP/1.1\\r\\n";
-    request += "Host: " + req_data->host + "\\r\\n";
-    request += "Connection: close\\r\\n";
-    request += "User-Agent: PicoW-Weather/1.0\\r\\n";
-    request += "\\r\\n";
-    
-    // Send HTTP request
-    err_t write_err = tcp_write(pcb, request.c_str(), request.length(), TCP_WRITE_FLAG_COPY);
-    if (write_err != ERR_OK) {
-        printf("NetworkManager: TCP write failed: %d\\n", write_err);
-        delete req_data;
-        return write_err;
+uint32_t NetworkManager::http_get(const std::string& url, std::function<void(const std::string&)> callback,
+                                  const RequestOptions& options) {
+    if (!is_connected()) {
+        printf("NetworkManager: HTTP GET failed - not connected\n");
+        return 0;
     }
-    
-    tcp_output(pcb);
-    
-    // Set up receive callback
-    tcp_recv(pcb, tcp_recv_callback);
-    tcp_arg(pcb, req_data->manager);
-    
-    delete req_data;
-    return ERR_OK;
+    return http.get(url, callback, options);
 }
 
-signed char NetworkManager::tcp_recv_callback(void* arg, struct tcp_pcb* pcb, struct pbuf* p, signed char err) {
-    NetworkManager* manager = (NetworkManager*)arg;
-    
-    if (p == nullptr) {
-        // Connection closed
-        tcp_close(pcb);
-        manager->tcp_pcb = nullptr;
-        
-        // Process response - skip HTTP headers
-        std::string& response = manager->response_buffer;
-        size_t body_start = response.find("\\r\\n\\r\\n");
-        if (body_start != std::string::npos) {
-            std::string body = response.substr(body_start + 4);
-            if (manager->response_callback) {
-                manager->response_callback(body);
-            }
+uint32_t NetworkManager::http_get_stream(const std::string& url, BodyCallback on_body, CompleteCallback on_complete,
+                                         const RequestOptions& options, ErrorCallback on_error) {
+    if (!is_connected()) {
+        printf("NetworkManager: HTTP GET failed - not connected\n");
+        if (on_error) {
+            on_error(HttpError::NOT_CONNECTED, 0);
         }
-        
-        manager->response_buffer.clear();
-        manager->response_callback = nullptr;
-        return ERR_OK;
+        if (on_complete) {
+            on_complete(false);
+        }
+        return 0;
     }
-    
-    // Append received data to buffer
-    char* data = (char*)p->payload;
-    manager->response_buffer.append(data, p->len);
-    
-    tcp_recved(pcb, p->len);
-    pbuf_free(p);
-    
-    return ERR_OK;
+    return http.get_stream(url, on_body, on_complete, options, on_error);
 }
 
-bool NetworkManager::http_get(const std::string& url, std::function<void(const std::string&)> callback) {
-    if (!is_connected()) {
-        printf("NetworkManager: HTTP GET failed - not connected\\n");
-        return false;
-    }
-    
-    if (tcp_pcb != nullptr) {
-        printf("NetworkManager: HTTP GET failed - connection busy\\n");
-        return false;
-    }
-    
-    response_callback = callback;
-    response_buffer.clear();
-    
-    std::string host, path;
-    parse_url(url, host, path);
-    
-    if (host.empty()) {
-        printf("NetworkManager: Invalid URL: %s\\n", url.c_str());
-        return false;
-    }
-    
-    printf("NetworkManager: HTTP GET %s%s\\n", host.c_str(), path.c_str());
-    
-    // Prepare request data
-    http_request_data* req_data = new http_request_data();
-    req_data->manager = this;
-    req_data->host = host;
-    req_data->path = path;
-    
-    // Resolve DNS
-    ip_addr_t server_ip;
-    err_t err = dns_gethostbyname(host.c_str(), &server_ip, dns_callback, req_data);
-    
-    if (err == ERR_OK) {
-        // IP was cached, call callback directly
-        dns_callback(host.c_str(), &server_ip, req_data);
-    } else if (err != ERR_INPROGRESS) {
-        printf("NetworkManager: DNS lookup failed immediately: %d\\n", err);
-        delete req_data;
-        return false;
-    }
-    
-    return true;
-}
\ No newline at end of file
+bool NetworkManager::cancel_request(uint32_t request_id) {
+    return http.cancel(request_id);
+}
@@ -1,8 +1,17 @@
 #pragma once
 
 #include "pico/stdlib.h"
+#include "http_client.h"
+#include "altcp_transport.h"
+#include "dns_cache.h"
+#include "wifi_connect_cache.h"
 #include <string>
 #include <functional>
+#include <vector>
+
+// Plain TCP connections only cost a PCB and pbufs; keep one of lwIP's
+// default five PCBs free for DNS/DHCP housekeeping and TIME_WAIT
+#define HTTP_MAX_CONCURRENT 3
 
 // Network connection states
 enum class NetworkState {
@@ -12,55 +21,104 @@ enum class NetworkState {
     ERROR
 };
 
-// Forward declarations to avoid header conflicts
-struct tcp_pcb;
-struct pbuf;
-struct ip4_addr;
-typedef struct ip4_addr ip_addr_t;
-
 // Network manager class - isolated from other headers to avoid conflicts
+// The only owner of the CYW43 radio: it initializes the chip, joins the
+// network without blocking and reconnects when the link drops. Apps learn
+// about connectivity through state listeners.
 class NetworkManager {
 public:
+    // Called on every state change, from process()
+    using StateCallback = std::function<void(NetworkState state)>;
+    
+    // Streaming callbacks: body bytes are delivered as each buffer arrives
+    // Chunks are views into the receive buffers, valid only during the call
+    using BodyCallback = HttpClient::BodyCallback;
+    using CompleteCallback = HttpClient::CompleteCallback;
+    using ErrorCallback = HttpClient::ErrorCallback;
+    
     NetworkManager();
     ~NetworkManager();
     
     // WiFi connection management
+    // Powers up the radio and starts joining ssid; returns straight away.
+    // Only fails if the chip itself cannot be initialized.
     bool init_wifi(const char* ssid, const char* password);
     bool is_connected() const;
     NetworkState get_state() const;
     void disconnect();
     
+    // Listen for state changes. Returns an id for remove_state_listener().
+    uint32_t add_state_listener(StateCallback callback);
+    void remove_state_listener(uint32_t listener_id);
+    
+    // Shared by every HTTP client on this link
+    DnsCache& get_dns_cache() { return dns_cache; }
+    
+    // Other HTTP clients on this link (e.g. HttpsClient) register here so
+    // process() runs their deadlines, pools and transports every frame,
+    // whichever app is on screen
+    void add_http_client(HttpClient* client);
+    void remove_http_client(HttpClient* client);
+    
     // HTTP client functionality
-    bool http_get(const std::string& url, std::function<void(const std::string&)> callback);
+    uint32_t http_get(const std::string& url, std::function<void(const std::string&)> callback,
+                      const RequestOptions& options = RequestOptions());
     
-    // Must be called regularly in main loop
+    // Streaming variant - the body is never buffered as a whole.
+    // Requests are queued; each one gets its own callbacks. on_error (optional)
+    // reports why a request failed before on_complete(false) is called.
+    // Returns a request id for cancel_request(), or 0 if rejected (not
+    // connected) - on_error and on_complete(false) have then already run.
+    uint32_t http_get_stream(const std::string& url, BodyCallback on_body, CompleteCallback on_complete,
+                             const RequestOptions& options = RequestOptions(), ErrorCallback on_error = nullptr);
+    
+    // Cancel a queued or in-flight request; its callbacks will not be called
+    bool cancel_request(uint32_t request_id);
+    
+    // Must be called regularly in main loop; also drives the registered clients
     void process();
     
+    // Write a changed WiFi association to flash. The erase stalls the panel
+    // refresh, so only call this on a frame that sends nothing to the panel.
+    void save_association() { connect_cache.flush(); }
+    
     // Status information
     std::string get_status_message() const;
+    std::string get_ip_address() const;
     int get_signal_strength() const;
     
 private:
+    struct StateListener {
+        uint32_t id;
+        StateCallback callback;
+    };
+    
     NetworkState state;
     bool wifi_initialized;
+    bool auto_reconnect;             // Cleared by disconnect()
     std::string wifi_ssid;
+    std::string wifi_password;
     std::string status_message;
     uint32_t last_connection_attempt;
     uint32_t connection_retry_delay;
     
-    // HTTP state
-    struct tcp_pcb* tcp_pcb;
-    std::function<void(const std::string&)> response_callback;
-    std::string response_buffer;
+    // Fast reconnect: join the cached access point directly, then full scan
+    WifiConnectCache connect_cache;
+    bool fast_connect_attempt;       // Current join names the BSSID and channel
+    std::vector<StateListener> listeners;
+    uint32_t next_listener_id;
+    
+    // HTTP state - plain HTTP with keep-alive, one request per connection at a time
+    DnsCache dns_cache;
+    TcpTransport tcp_transport;
+    HttpClient http;
+    std::vector<HttpClient*> http_clients;   // Registered with add_http_client()
     
     // Internal methods
     void update_connection_state();
     bool attempt_wifi_connection();
+    bool start_fast_connect(const WifiConnectCache::Record& cached);
+    void remember_association();
+    void set_state(NetworkState new_state, const char* message);
     void cleanup_tcp_connection();
-    void parse_url(const std::string& url, std::string& host, std::string& path);
-    
-    // Static callbacks (must be static for C-style callbacks)
-    static void dns_callback(const char* name, const ip_addr_t* ipaddr, void* arg);
-    static signed char tcp_connected_callback(void* arg, struct tcp_pcb* pcb, signed char err);
-    static signed char tcp_recv_callback(void* arg, struct tcp_pcb* pcb, struct pbuf* p, signed char err);
 };
\ No newline at end of file
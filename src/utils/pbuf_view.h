@@ -0,0 +1,33 @@
+#pragma once
+
+// Prevent PNG zutil.h macro conflict with lwIP
+#ifdef local
+#undef local
+#endif
+
+#include "lwip/pbuf.h"
+#include <string_view>
+
+// Walk every segment of a received pbuf chain without copying.
+// `fn` gets a string_view over each segment's payload and returns false to
+// stop early (e.g. once a response is complete). The views are only valid
+// until the chain is freed, so consumers must not keep them.
+// Returns the number of bytes visited.
+template <typename SegmentFn>
+inline size_t for_each_pbuf_segment(const struct pbuf* p, SegmentFn fn) {
+    size_t visited = 0;
+    size_t remaining = p ? p->tot_len : 0;
+    
+    for (const struct pbuf* q = p; q != nullptr && remaining > 0; q = q->next) {
+        size_t len = q->len < remaining ? q->len : remaining;
+        if (len > 0) {
+            visited += len;
+            remaining -= len;
+            if (!fn(std::string_view((const char*)q->payload, len))) {
+                break;
+            }
+        }
+    }
+    
+    return visited;
+}
@@ -0,0 +1,526 @@
+#include "posix_transport.h"
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+// Bytes read from a socket per on_data() call
+#define POSIX_RECV_BUFFER 4096
+
+static uint32_t now_ms() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Every live transport, so wait() can sleep on all their sockets at once
+static std::vector<PosixTransport*> all_transports;
+
+// ---------------------------------------------------------------------------
+// PosixConnection
+// ---------------------------------------------------------------------------
+
+PosixConnection::PosixConnection(PosixTransport* transport, const std::string& host, uint16_t port)
+    : connect_started_ms(0)
+    , dns_ms(0)
+    , session_offered(false)
+    , transport(transport)
+    , listener(nullptr)
+    , host(host)
+    , port(port)
+    , fd(-1)
+    , ssl(nullptr)
+    , state(State::IDLE)
+    , serial(0)
+    , tls_wants_write(false)
+    , depth(0) {
+}
+
+PosixConnection::~PosixConnection() {
+}
+
+void PosixConnection::leave() {
+    if (--depth == 0 && state == State::CLOSED) {
+        delete this;
+    }
+}
+
+void PosixConnection::connect(TransportListener* listener) {
+    this->listener = listener;
+    connect_started_ms = now_ms();
+    enter();
+    
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    
+    struct addrinfo* addresses = nullptr;
+    std::string service = std::to_string(port);
+    int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+    dns_ms = now_ms() - connect_started_ms;
+    if (rc != 0 || addresses == nullptr) {
+        printf("PosixConnection: DNS lookup for %s failed: %s\n", host.c_str(), gai_strerror(rc));
+        fail(HttpError::DNS_FAILED);
+        leave();
+        return;
+    }
+    
+    // First address that takes a non-blocking connect
+    connect_started_ms = now_ms();
+    for (struct addrinfo* address = addresses; address != nullptr && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        if (::connect(fd, address->ai_addr, address->ai_addrlen) != 0 && errno != EINPROGRESS) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    
+    if (fd < 0) {
+        printf("PosixConnection: Connect to %s:%u failed: %s\n", host.c_str(), (unsigned)port, strerror(errno));
+        fail(HttpError::CONNECT_FAILED);
+        leave();
+        return;
+    }
+    
+    // Completion shows up as the socket turning writable
+    state = State::CONNECTING;
+    transport->attach(this);
+    leave();
+}
+
+short PosixConnection::wanted_events() const {
+    switch (state) {
+        case State::CONNECTING:
+            return POLLOUT;
+        case State::HANDSHAKING:
+            return tls_wants_write ? POLLOUT : POLLIN;
+        case State::READY:
+            return POLLIN | (outbox.empty() ? 0 : POLLOUT);
+        default:
+            return 0;
+    }
+}
+
+void PosixConnection::handle_events(short revents) {
+    enter();
+    
+    if (state == State::CONNECTING) {
+        on_socket_connected();
+    } else if (state == State::HANDSHAKING) {
+        continue_handshake();
+    } else if (state == State::READY) {
+        if ((revents & POLLOUT) && !outbox.empty()) {
+            HttpError error = flush();
+            if (error != HttpError::NONE) {
+                fail(error);
+            }
+        }
+        if (state == State::READY && (revents & (POLLIN | POLLHUP | POLLERR))) {
+            receive();
+        }
+    }
+    
+    leave();
+}
+
+void PosixConnection::on_socket_connected() {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+        printf("PosixConnection: Connection to %s failed: %s\n", host.c_str(), strerror(error));
+        fail(HttpError::CONNECT_FAILED);
+        return;
+    }
+    
+    if (!transport->start_tls(this)) {
+        fail(HttpError::CONNECT_FAILED);
+        return;
+    }
+    
+    if (ssl) {
+        state = State::HANDSHAKING;
+        continue_handshake();
+    } else {
+        established();
+    }
+}
+
+void PosixConnection::continue_handshake() {
+    int rc = SSL_connect(ssl);
+    if (rc == 1) {
+        established();
+        return;
+    }
+    
+    switch (SSL_get_error(ssl, rc)) {
+        case SSL_ERROR_WANT_READ:
+            tls_wants_write = false;
+            break;
+        case SSL_ERROR_WANT_WRITE:
+            tls_wants_write = true;
+            break;
+        default: {
+            char reason[128];
+            ERR_error_string_n(ERR_get_error(), reason, sizeof(reason));
+            printf("PosixConnection: TLS handshake with %s failed: %s\n", host.c_str(), reason);
+            fail(HttpError::CONNECT_FAILED);
+            break;
+        }
+    }
+}
+
+void PosixConnection::established() {
+    state = State::READY;
+    transport->on_established(this);
+    if (listener) {
+        listener->on_connected(this);
+    }
+}
+
+void PosixConnection::receive() {
+    char buffer[POSIX_RECV_BUFFER];
+    
+    // Until the socket (and OpenSSL's buffer) is drained, or the listener closes us
+    while (state == State::READY) {
+        ssize_t received;
+        bool again = false;
+        bool peer_closed = false;
+        
+        if (ssl) {
+            int rc = SSL_read(ssl, buffer, sizeof(buffer));
+            received = rc;
+            if (rc <= 0) {
+                int error = SSL_get_error(ssl, rc);
+                again = error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE;
+                peer_closed = error == SSL_ERROR_ZERO_RETURN;
+            }
+        } else {
+            received = recv(fd, buffer, sizeof(buffer), 0);
+            again = received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+            peer_closed = received == 0;
+        }
+        
+        if (received > 0) {
+            if (listener) {
+                listener->on_data(this, std::string_view(buffer, (size_t)received));
+            }
+            continue;
+        }
+        if (again) {
+            return;
+        }
+        
+        if (peer_closed) {
+            TransportListener* notify = listener;
+            close(false);
+            if (notify) {
+                notify->on_closed(this, HttpError::NONE);
+            }
+        } else {
+            printf("PosixConnection: Connection to %s lost: %s\n", host.c_str(), strerror(errno));
+            fail(HttpError::CONNECTION_LOST);
+        }
+        return;
+    }
+}
+
+HttpError PosixConnection::flush() {
+    while (!outbox.empty()) {
+        ssize_t sent;
+        bool again = false;
+        
+        if (ssl) {
+            int rc = SSL_write(ssl, outbox.data(), (int)outbox.size());
+            sent = rc;
+            if (rc <= 0) {
+                int error = SSL_get_error(ssl, rc);
+                again = error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE;
+            }
+        } else {
+            sent = send(fd, outbox.data(), outbox.size(), MSG_NOSIGNAL);
+            again = sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        }
+        
+        if (sent > 0) {
+            outbox.erase(0, (size_t)sent);
+        } else if (again) {
+            return HttpError::NONE;  // The rest goes out when poll() says so
+        } else {
+            printf("PosixConnection: Write to %s failed: %s\n", host.c_str(), strerror(errno));
+            return HttpError::CONNECTION_LOST;
+        }
+    }
+    return HttpError::NONE;
+}
+
+HttpError PosixConnection::write(std::string_view data) {
+    if (state != State::READY) {
+        return HttpError::CONNECTION_LOST;
+    }
+    
+    outbox.append(data.data(), data.size());
+    return flush();
+}
+
+void PosixConnection::fail(HttpError error) {
+    if (state == State::CLOSED) {
+        return;
+    }
+    if (state != State::READY) {
+        transport->on_connect_failed(this);
+    }
+    
+    TransportListener* notify = listener;
+    close(true);
+    if (notify) {
+        notify->on_closed(this, error);
+    }
+}
+
+void PosixConnection::close(bool abort) {
+    if (state == State::CLOSED) {
+        return;
+    }
+    bool was_ready = state == State::READY;
+    state = State::CLOSED;
+    listener = nullptr;
+    
+    if (ssl) {
+        if (!abort && was_ready) {
+            SSL_shutdown(ssl);  // Best effort close_notify - not waited for
+        }
+        SSL_free(ssl);
+        ssl = nullptr;
+    }
+    
+    if (fd >= 0) {
+        if (abort) {
+            // Reset rather than linger, like altcp_abort()
+            struct linger reset = { 1, 0 };
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    
+    transport->detach(this);
+    if (depth == 0) {
+        delete this;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PosixTransport
+// ---------------------------------------------------------------------------
+
+PosixTransport::PosixTransport()
+    : next_serial(1) {
+    all_transports.push_back(this);
+}
+
+PosixTransport::~PosixTransport() {
+    std::vector<PosixConnection*> open = connections;
+    for (PosixConnection* connection : open) {
+        connection->close(true);
+    }
+    all_transports.erase(std::remove(all_transports.begin(), all_transports.end(), this), all_transports.end());
+}
+
+TransportConnection* PosixTransport::create(const std::string& host, uint16_t port) {
+    return new PosixConnection(this, host, port);
+}
+
+void PosixTransport::attach(PosixConnection* connection) {
+    connection->serial = next_serial++;
+    connections.push_back(connection);
+}
+
+void PosixTransport::detach(PosixConnection* connection) {
+    connections.erase(std::remove(connections.begin(), connections.end(), connection), connections.end());
+}
+
+void PosixTransport::process(uint32_t now_ms) {
+    (void)now_ms;
+    if (connections.empty()) {
+        return;
+    }
+    
+    // Events may close connections and open new ones, so each socket is
+    // looked up again by serial before its events are delivered
+    std::vector<struct pollfd> fds;
+    std::vector<uint32_t> serials;
+    for (PosixConnection* connection : connections) {
+        fds.push_back({ connection->fd, connection->wanted_events(), 0 });
+        serials.push_back(connection->serial);
+    }
+    
+    if (poll(fds.data(), fds.size(), 0) <= 0) {
+        return;
+    }
+    
+    for (size_t i = 0; i < fds.size(); i++) {
+        if (fds[i].revents == 0) {
+            continue;
+        }
+        for (PosixConnection* connection : connections) {
+            if (connection->serial == serials[i]) {
+                connection->handle_events(fds[i].revents);
+                break;
+            }
+        }
+    }
+}
+
+void PosixTransport::wait(uint32_t timeout_ms) {
+    std::vector<struct pollfd> fds;
+    for (PosixTransport* transport : all_transports) {
+        for (PosixConnection* connection : transport->connections) {
+            fds.push_back({ connection->fd, connection->wanted_events(), 0 });
+        }
+    }
+    
+    if (fds.empty()) {
+        usleep(timeout_ms * 1000);
+        return;
+    }
+    poll(fds.data(), fds.size(), (int)timeout_ms);
+}
+
+void PosixTransport::on_established(PosixConnection* connection) {
+    printf("PosixTransport: Connected to %s in %lu ms (DNS %lu ms)\n", connection->get_host().c_str(),
+           (unsigned long)(now_ms() - connection->connect_started_ms), (unsigned long)connection->dns_ms);
+}
+
+// ---------------------------------------------------------------------------
+// PosixTlsTransport
+// ---------------------------------------------------------------------------
+
+PosixTlsTransport::PosixTlsTransport(bool verify_peer)
+    : ctx(SSL_CTX_new(TLS_client_method()))
+    , verify_peer(verify_peer)
+    , handshake_stats{0, 0, 0, 0, UINT32_MAX, 0} {
+    if (ctx == nullptr) {
+        printf("PosixTlsTransport: Failed to create the OpenSSL context\n");
+        return;
+    }
+    
+    SSL_CTX_set_app_data(ctx, this);
+    SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    // A TCP close without close_notify ends the stream, as it does over altcp
+    SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+    if (verify_peer) {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+        SSL_CTX_set_default_verify_paths(ctx);
+    }
+    
+    // Sessions (and TLS 1.3 tickets, which arrive after the handshake) are
+    // kept here per host, like TlsSessionCache does on the device
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, new_session_callback);
+}
+
+PosixTlsTransport::~PosixTlsTransport() {
+    for (auto& entry : sessions) {
+        SSL_SESSION_free(entry.second);
+    }
+    sessions.clear();
+    if (ctx) {
+        SSL_CTX_free(ctx);
+        ctx = nullptr;
+    }
+}
+
+bool PosixTlsTransport::start_tls(PosixConnection* connection) {
+    if (ctx == nullptr) {
+        return false;
+    }
+    
+    SSL* ssl = SSL_new(ctx);
+    if (ssl == nullptr) {
+        return false;
+    }
+    SSL_set_app_data(ssl, connection);
+    SSL_set_fd(ssl, connection->fd);
+    SSL_set_tlsext_host_name(ssl, connection->get_host().c_str());
+    if (verify_peer) {
+        SSL_set1_host(ssl, connection->get_host().c_str());
+    }
+    
+    // Offer the last session with this host for an abbreviated handshake
+    auto cached = sessions.find(connection->get_host());
+    connection->session_offered = cached != sessions.end() && SSL_set_session(ssl, cached->second) == 1;
+    
+    connection->ssl = ssl;
+    return true;
+}
+
+int PosixTlsTransport::new_session_callback(SSL* ssl, SSL_SESSION* session) {
+    PosixConnection* connection = (PosixConnection*)SSL_get_app_data(ssl);
+    PosixTlsTransport* transport = (PosixTlsTransport*)SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    if (connection == nullptr || transport == nullptr) {
+        return 0;
+    }
+    
+    transport->forget_session(connection->get_host());
+    transport->sessions[connection->get_host()] = session;
+    return 1;  // The reference is ours now
+}
+
+void PosixTlsTransport::forget_session(const std::string& host) {
+    auto cached = sessions.find(host);
+    if (cached != sessions.end()) {
+        SSL_SESSION_free(cached->second);
+        sessions.erase(cached);
+    }
+}
+
+void PosixTlsTransport::on_established(PosixConnection* connection) {
+    SSL* ssl = connection->get_ssl();
+    uint32_t handshake_ms = now_ms() - connection->connect_started_ms;
+    bool resumed = SSL_session_reused(ssl) == 1;
+    
+    HandshakeStats& stats = handshake_stats;
+    stats.count++;
+    stats.total_ms += handshake_ms;
+    stats.min_ms = std::min(stats.min_ms, handshake_ms);
+    stats.max_ms = std::max(stats.max_ms, handshake_ms);
+    if (connection->session_offered) {
+        stats.resumption_offered++;
+    }
+    if (resumed) {
+        stats.resumed++;
+    }
+    
+    printf("HTTPS connected to %s in %lu ms after %lu ms DNS (%s %s, %s) - avg %lu ms over %lu\n",
+           connection->get_host().c_str(), (unsigned long)handshake_ms, (unsigned long)connection->dns_ms,
+           SSL_get_version(ssl), SSL_get_cipher(ssl), resumed ? "resumed" : "full handshake",
+           (unsigned long)(stats.total_ms / stats.count), (unsigned long)stats.count);
+}
+
+void PosixTlsTransport::on_connect_failed(PosixConnection* connection) {
+    if (connection->session_offered) {
+        // The server may have choked on a stale session - start clean next time
+        forget_session(connection->get_host());
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "http_transport.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// OpenSSL types - the library headers stay out of this one
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+class PosixTransport;
+
+// One non-blocking socket connection, plain TCP or TLS over OpenSSL
+// The host counterpart of AltcpConnection, with the same event contract.
+// Sockets are polled by PosixTransport::process(); DNS (getaddrinfo) is
+// the only call that blocks.
+class PosixConnection : public TransportConnection {
+public:
+    PosixConnection(PosixTransport* transport, const std::string& host, uint16_t port);
+    
+    void connect(TransportListener* listener) override;
+    HttpError write(std::string_view data) override;
+    void close(bool abort) override;
+    
+    const std::string& get_host() const { return host; }
+    SSL* get_ssl() const { return ssl; }
+    
+    // Set up by the transport around the connect
+    uint32_t connect_started_ms;
+    uint32_t dns_ms;
+    bool session_offered;        // TLS: cached session offered for resumption
+    
+private:
+    friend class PosixTransport;
+    friend class PosixTlsTransport;
+    
+    enum class State : uint8_t {
+        IDLE,
+        CONNECTING,
+        HANDSHAKING,
+        READY,
+        CLOSED
+    };
+    
+    PosixTransport* transport;
+    TransportListener* listener;
+    std::string host;
+    uint16_t port;
+    int fd;
+    SSL* ssl;                    // nullptr for plain TCP
+    State state;
+    uint32_t serial;             // Tells a new connection from a freed one at the same address
+    std::string outbox;          // Written but not yet accepted by the socket
+    bool tls_wants_write;        // Handshake is blocked on the socket becoming writable
+    int depth;                   // Nesting of events being delivered
+    
+    ~PosixConnection();
+    
+    // Events run between enter() and leave(); a connection closed meanwhile
+    // is freed by the outermost leave()
+    void enter() { depth++; }
+    void leave();
+    
+    short wanted_events() const;
+    void handle_events(short revents);
+    void on_socket_connected();
+    void continue_handshake();
+    void established();
+    void receive();
+    HttpError flush();
+    void fail(HttpError error);
+};
+
+// Plain HTTP over POSIX sockets, for host builds of the HTTP stack
+class PosixTransport : public HttpTransport {
+public:
+    PosixTransport();
+    virtual ~PosixTransport();
+    
+    uint16_t default_port() const override { return 80; }
+    TransportConnection* create(const std::string& host, uint16_t port) override;
+    
+    // Poll this transport's sockets once, without blocking, and deliver events
+    void process(uint32_t now_ms) override;
+    
+    // Block until a socket of any PosixTransport has something to do, or
+    // timeout_ms passes - lets a host main loop sleep between process() calls
+    static void wait(uint32_t timeout_ms);
+    
+    size_t get_connection_count() const { return connections.size(); }
+    
+protected:
+    friend class PosixConnection;
+    
+    // Set up TLS on a connected socket (plain TCP: nothing to do).
+    // Returns false if that failed.
+    virtual bool start_tls(PosixConnection* connection) { (void)connection; return true; }
+    
+    // The stream is up / setting it up failed
+    virtual void on_established(PosixConnection* connection);
+    virtual void on_connect_failed(PosixConnection* connection) { (void)connection; }
+    
+private:
+    std::vector<PosixConnection*> connections;
+    uint32_t next_serial;
+    
+    void attach(PosixConnection* connection);
+    void detach(PosixConnection* connection);
+};
+
+// HTTPS over POSIX sockets and OpenSSL, with per-host session resumption
+class PosixTlsTransport : public PosixTransport {
+public:
+    // Handshake metrics, comparable with TlsTransport's on the device
+    struct HandshakeStats {
+        uint32_t count;
+        uint32_t resumption_offered;
+        uint32_t resumed;            // Server accepted the offered session
+        uint32_t total_ms;
+        uint32_t min_ms;
+        uint32_t max_ms;
+    };
+    
+    // verify_peer = false accepts any certificate (local test servers)
+    explicit PosixTlsTransport(bool verify_peer = true);
+    ~PosixTlsTransport();
+    
+    uint16_t default_port() const override { return 443; }
+    
+    const HandshakeStats& get_handshake_stats() const { return handshake_stats; }
+    
+protected:
+    bool start_tls(PosixConnection* connection) override;
+    void on_established(PosixConnection* connection) override;
+    void on_connect_failed(PosixConnection* connection) override;
+    
+private:
+    SSL_CTX* ctx;
+    bool verify_peer;
+    std::map<std::string, SSL_SESSION*> sessions;  // Latest resumable session per host
+    HandshakeStats handshake_stats;
+    
+    void forget_session(const std::string& host);
+    static int new_session_callback(SSL* ssl, SSL_SESSION* session);
+};
@@ -0,0 +1,337 @@
+#include "request_queue.h"
+#include <cstdio>
+#include <algorithm>
+
+const char* http_error_name(HttpError error) {
+    switch (error) {
+        case HttpError::NONE: return "none";
+        case HttpError::NOT_CONNECTED: return "not connected";
+        case HttpError::INVALID_URL: return "invalid URL";
+        case HttpError::DNS_FAILED: return "DNS failed";
+        case HttpError::CONNECT_FAILED: return "connect failed";
+        case HttpError::CONNECT_TIMEOUT: return "connect timeout";
+        case HttpError::FIRST_BYTE_TIMEOUT: return "first byte timeout";
+        case HttpError::TOTAL_TIMEOUT: return "total timeout";
+        case HttpError::CONNECTION_LOST: return "connection lost";
+        case HttpError::BAD_RESPONSE: return "bad response";
+        case HttpError::HTTP_STATUS: return "HTTP status";
+        case HttpError::OUT_OF_MEMORY: return "out of memory";
+        case HttpError::CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+RequestQueue::RequestQueue(Starter starter, Aborter aborter, size_t max_concurrent)
+    : starter(starter)
+    , aborter(aborter)
+    , max_concurrent(max_concurrent > 0 ? max_concurrent : 1)
+    , active(0)
+    , next_id(1)
+    , now_ms(0)
+    , jitter_state(0x9E3779B9u)
+    , processing(false) {
+}
+
+uint32_t RequestQueue::allocate_id() {
+    uint32_t id = next_id++;
+    if (next_id == 0) {
+        next_id = 1;
+    }
+    return id;
+}
+
+uint32_t RequestQueue::backoff_delay(uint8_t attempt) {
+    uint32_t delay = RETRY_BACKOFF_BASE_MS << (attempt < 8 ? attempt : 8);
+    if (delay > RETRY_BACKOFF_MAX_MS) {
+        delay = RETRY_BACKOFF_MAX_MS;
+    }
+    
+    // xorshift32, stirred with the clock so devices do not share a sequence
+    jitter_state ^= now_ms;
+    jitter_state ^= jitter_state << 13;
+    jitter_state ^= jitter_state >> 17;
+    jitter_state ^= jitter_state << 5;
+    
+    return delay / 2 + jitter_state % (delay + 1);
+}
+
+bool RequestQueue::is_retryable(HttpError error, int status_code) {
+    switch (error) {
+        case HttpError::DNS_FAILED:
+        case HttpError::CONNECT_FAILED:
+        case HttpError::CONNECT_TIMEOUT:
+        case HttpError::FIRST_BYTE_TIMEOUT:
+        case HttpError::TOTAL_TIMEOUT:
+        case HttpError::CONNECTION_LOST:
+        case HttpError::OUT_OF_MEMORY:
+            return true;
+        case HttpError::HTTP_STATUS:
+            // Server-side trouble or rate limiting may clear up
+            return status_code >= 500 || status_code == 429;
+        default:
+            return false;
+    }
+}
+
+uint32_t RequestQueue::enqueue(const std::string& url, const RequestOptions& options,
+                               BodyCallback on_body, CompleteCallback on_complete, ErrorCallback on_error) {
+    uint32_t id = allocate_id();
+    
+    // Merge with an identical fetch that has not started delivering data yet
+    for (Entry& entry : entries) {
+        if (entry.url == url && !entry.body_started) {
+            entry.subscribers.push_back({id, on_body, on_complete, on_error, false});
+            if (options.priority < entry.options.priority) {
+                entry.options.priority = options.priority;
+            }
+            printf("RequestQueue: Coalesced request for %s\n", url.c_str());
+            return id;
+        }
+    }
+    
+    Entry entry;
+    entry.fetch_id = 0;
+    entry.url = url;
+    entry.options = options;
+    entry.started = false;
+    entry.body_started = false;
+    entry.delivering = false;
+    entry.attempts = 0;
+    entry.not_before_ms = now_ms;
+    entry.subscribers.push_back({id, on_body, on_complete, on_error, false});
+    entries.push_back(entry);
+    
+    // Cached answers wait for the next process() so callbacks never run
+    // before the caller has its request id
+    start_ready(false);
+    return id;
+}
+
+bool RequestQueue::cancel(uint32_t request_id) {
+    for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+        for (auto sub = entry->subscribers.begin(); sub != entry->subscribers.end(); ++sub) {
+            if (sub->id != request_id) {
+                continue;
+            }
+            
+            if (sub->cancelled) {
+                return false;
+            }
+            
+            // Mid-delivery the list is being walked - deliver_body drops it after
+            if (entry->delivering) {
+                sub->cancelled = true;
+                return true;
+            }
+            
+            entry->subscribers.erase(sub);
+            if (entry->subscribers.empty()) {
+                if (entry->started) {
+                    // Client reports CANCELLED, which removes the entry
+                    aborter(entry->fetch_id);
+                } else {
+                    entries.erase(entry);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RequestQueue::pending_count() const {
+    size_t count = 0;
+    for (const Entry& entry : entries) {
+        if (!entry.started) {
+            count++;
+        }
+    }
+    return count;
+}
+
+std::list<RequestQueue::Entry>::iterator RequestQueue::find_entry(uint32_t fetch_id) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->started && it->fetch_id == fetch_id) {
+            return it;
+        }
+    }
+    return entries.end();
+}
+
+void RequestQueue::deliver_body(uint32_t fetch_id, std::string_view chunk) {
+    auto entry = find_entry(fetch_id);
+    if (entry == entries.end()) {
+        return;
+    }
+    
+    entry->body_started = true;
+    if (entry->options.use_cache) {
+        entry->capture.on_body(chunk);
+    }
+    // Callbacks may cancel themselves or others: cancel() only marks them
+    // while this runs, and nothing can join a fetch that has body data
+    entry->delivering = true;
+    for (size_t i = 0; i < entry->subscribers.size(); i++) {
+        Subscriber& subscriber = entry->subscribers[i];
+        if (!subscriber.cancelled && subscriber.on_body) {
+            subscriber.on_body(chunk);
+        }
+    }
+    entry->delivering = false;
+    
+    auto& subscribers = entry->subscribers;
+    auto cancelled = std::remove_if(subscribers.begin(), subscribers.end(),
+                                    [](const Subscriber& subscriber) { return subscriber.cancelled; });
+    if (cancelled == subscribers.end()) {
+        return;
+    }
+    subscribers.erase(cancelled, subscribers.end());
+    if (subscribers.empty()) {
+        // Client reports CANCELLED, which removes the entry - not used after this
+        aborter(fetch_id);
+    }
+}
+
+void RequestQueue::complete_fetch(uint32_t fetch_id, HttpError error, int status_code) {
+    auto entry = find_entry(fetch_id);
+    if (entry == entries.end()) {
+        return;
+    }
+    
+    entry->started = false;
+    if (active > 0) {
+        active--;
+    }
+    
+    if (entry->options.use_cache) {
+        if (error == HttpError::NONE) {
+            cache.store(entry->url, entry->capture, now_ms);
+        } else if (error == HttpError::HTTP_STATUS && status_code == 304) {
+            // Not modified - replay the body we already have
+            const std::string* body = cache.revalidated(entry->url, entry->capture, now_ms);
+            if (body) {
+                serve_cached(entry, *body);
+            } else {
+                // Evicted meanwhile - fetch again without validators
+                entry->not_before_ms = now_ms;
+            }
+            process(now_ms);
+            return;
+        }
+        entry->capture.reset();
+    }
+    
+    // Retry transient failures as long as no caller has seen partial data
+    if (error != HttpError::NONE && !entry->subscribers.empty() && !entry->body_started &&
+        entry->attempts <= entry->options.max_retries && is_retryable(error, status_code)) {
+        uint32_t delay = backoff_delay(entry->attempts - 1);
+        entry->not_before_ms = now_ms + delay;
+        printf("RequestQueue: %s failed (%s), retry %d in %lu ms\n", entry->url.c_str(),
+               http_error_name(error), entry->attempts, (unsigned long)delay);
+        process(now_ms);
+        return;
+    }
+    
+    // Detach before notifying - callbacks may queue follow-up requests
+    std::vector<Subscriber> subscribers = std::move(entry->subscribers);
+    entries.erase(entry);
+    
+    for (Subscriber& subscriber : subscribers) {
+        if (error != HttpError::NONE && subscriber.on_error) {
+            subscriber.on_error(error, status_code);
+        }
+        if (subscriber.on_complete) {
+            subscriber.on_complete(error == HttpError::NONE);
+        }
+    }
+    
+    process(now_ms);
+}
+
+void RequestQueue::start_entry(std::list<Entry>::iterator entry) {
+    entry->started = true;
+    entry->attempts++;
+    entry->fetch_id = allocate_id();
+    entry->capture.reset();
+    active++;
+    
+    // Stale cached copies are revalidated instead of downloaded again
+    std::string extra_headers = entry->options.use_cache ? cache.conditional_headers(entry->url) : "";
+    
+    uint32_t fetch_id = entry->fetch_id;
+    starter(fetch_id, entry->url, entry->options, extra_headers,
+        [this, fetch_id](const std::string& name, const std::string& value) {
+            auto entry = find_entry(fetch_id);
+            if (entry != entries.end() && entry->options.use_cache) {
+                entry->capture.on_header(name, value);
+            }
+        },
+        [this, fetch_id](std::string_view chunk) {
+            deliver_body(fetch_id, chunk);
+        },
+        [this, fetch_id](HttpError error, int status_code) {
+            complete_fetch(fetch_id, error, status_code);
+        });
+}
+
+void RequestQueue::serve_cached(std::list<Entry>::iterator entry, std::string body) {
+    // Detach before notifying - callbacks may queue follow-up requests
+    std::vector<Subscriber> subscribers = std::move(entry->subscribers);
+    entries.erase(entry);
+    
+    for (Subscriber& subscriber : subscribers) {
+        if (subscriber.on_body && !body.empty()) {
+            subscriber.on_body(body);
+        }
+        if (subscriber.on_complete) {
+            subscriber.on_complete(true);
+        }
+    }
+}
+
+void RequestQueue::process(uint32_t now) {
+    now_ms = now;
+    start_ready(true);
+}
+
+void RequestQueue::start_ready(bool serve_from_cache) {
+    // Guard against re-entry from completion callbacks
+    if (processing) {
+        return;
+    }
+    processing = true;
+    
+    // Answer requests that have a fresh cached response - no slot needed
+    for (auto it = entries.begin(); serve_from_cache && it != entries.end();) {
+        const std::string* body = nullptr;
+        if (!it->started && it->options.use_cache) {
+            body = cache.lookup_fresh(it->url, now_ms);
+        }
+        if (body == nullptr) {
+            ++it;
+            continue;
+        }
+        printf("RequestQueue: %s served from cache\n", it->url.c_str());
+        serve_cached(it, *body);
+        it = entries.begin();  // Callbacks may have changed the list
+    }
+    
+    while (active < max_concurrent) {
+        // Highest priority first, FIFO within the same priority
+        auto next = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            bool due = (int32_t)(now_ms - it->not_before_ms) >= 0;
+            bool cached = !serve_from_cache && it->options.use_cache && cache.is_fresh(it->url, now_ms);
+            if (!it->started && due && !cached &&
+                (next == entries.end() || it->options.priority < next->options.priority)) {
+                next = it;
+            }
+        }
+        if (next == entries.end()) {
+            break;
+        }
+        start_entry(next);
+    }
+    
+    processing = false;
+}
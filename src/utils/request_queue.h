@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <list>
+#include <vector>
+#include <cstdint>
+#include "http_cache.h"
+
+// Request priorities - lower value is started first
+enum class RequestPriority : uint8_t {
+    HIGH = 0,    // User-triggered refresh
+    NORMAL = 1,  // Scheduled app refresh
+    LOW = 2      // Background/prefetch
+};
+
+// Why a request failed
+enum class HttpError : uint8_t {
+    NONE,
+    NOT_CONNECTED,       // WiFi is down
+    INVALID_URL,
+    DNS_FAILED,
+    CONNECT_FAILED,      // TCP refused/reset or TLS handshake failed
+    CONNECT_TIMEOUT,     // DNS + TCP + TLS took longer than connect_timeout_ms
+    FIRST_BYTE_TIMEOUT,  // Request sent but no response within first_byte_timeout_ms
+    TOTAL_TIMEOUT,       // Whole request exceeded total_timeout_ms
+    CONNECTION_LOST,     // Peer closed or reset before the response was complete
+    BAD_RESPONSE,        // Malformed HTTP
+    HTTP_STATUS,         // Server answered with a non-2xx status
+    OUT_OF_MEMORY,
+    CANCELLED
+};
+
+const char* http_error_name(HttpError error);
+
+// Per-request deadlines and retry policy (0 disables a deadline)
+struct RequestOptions {
+    RequestPriority priority = RequestPriority::NORMAL;
+    uint32_t connect_timeout_ms = 15000;     // DNS + TCP + TLS handshake
+    uint32_t first_byte_timeout_ms = 10000;  // Request sent -> first response byte
+    uint32_t total_timeout_ms = 30000;       // Start -> response complete
+    uint8_t max_retries = 2;                 // Extra attempts for transient failures
+    bool use_cache = true;                   // Serve/revalidate through the response cache
+};
+
+// Retry backoff: base * 2^attempt, capped, with +/-50% jitter so displays
+// that lost the same access point do not retry in lockstep
+#define RETRY_BACKOFF_BASE_MS 1000
+#define RETRY_BACKOFF_MAX_MS 16000
+
+// HTTP request scheduler shared by the HTTP clients
+// Requests wait in a priority queue until a connection slot is free.
+// Requests for a URL that is already queued (or in flight but not yet
+// receiving its body) are merged into one fetch; every caller still gets its
+// own body and completion callbacks. Failed fetches that have not delivered
+// any body data are retried with jittered exponential backoff. Responses
+// pass through an HttpCache: fresh ones are answered locally, stale ones
+// are fetched conditionally.
+class RequestQueue {
+public:
+    using BodyCallback = std::function<void(std::string_view chunk)>;
+    using CompleteCallback = std::function<void(bool success)>;
+    using ErrorCallback = std::function<void(HttpError error, int status_code)>;
+    
+    // Outcome of one fetch attempt, reported by the client
+    using ResultCallback = std::function<void(HttpError error, int status_code)>;
+    
+    // Response headers of a fetch attempt, reported by the client
+    using HeaderCallback = std::function<void(const std::string& name, const std::string& value)>;
+    
+    // Starts one fetch attempt on the underlying client. extra_headers are
+    // complete CRLF-terminated lines to add to the request. The client must
+    // call on_result exactly once (possibly before returning).
+    using Starter = std::function<void(uint32_t fetch_id, const std::string& url, const RequestOptions& options,
+                                       const std::string& extra_headers, HeaderCallback on_header,
+                                       BodyCallback on_body, ResultCallback on_result)>;
+    
+    // Aborts an in-flight attempt; the client then reports CANCELLED
+    using Aborter = std::function<void(uint32_t fetch_id)>;
+    
+    RequestQueue(Starter starter, Aborter aborter, size_t max_concurrent);
+    
+    // Queue a request. Returns its id (never 0) for cancel().
+    uint32_t enqueue(const std::string& url, const RequestOptions& options,
+                     BodyCallback on_body, CompleteCallback on_complete, ErrorCallback on_error = nullptr);
+    
+    // Drop a request. Its callbacks are not called. The shared fetch is
+    // aborted once no caller is interested in it any more.
+    bool cancel(uint32_t request_id);
+    
+    // Start queued requests and due retries while connection slots are free
+    void process(uint32_t now_ms);
+    
+    size_t pending_count() const;
+    size_t active_count() const { return active; }
+    const HttpCache& get_cache() const { return cache; }
+    
+private:
+    struct Subscriber {
+        uint32_t id;
+        BodyCallback on_body;
+        CompleteCallback on_complete;
+        ErrorCallback on_error;
+        bool cancelled;           // Cancelled during a body delivery, dropped after it
+    };
+    
+    struct Entry {
+        uint32_t fetch_id;        // Id of the current attempt
+        std::string url;
+        RequestOptions options;
+        bool started;
+        bool body_started;
+        bool delivering;          // Inside the subscribers' body callbacks
+        uint8_t attempts;
+        uint32_t not_before_ms;   // Backoff - do not start before this time
+        std::vector<Subscriber> subscribers;
+        HttpCache::Capture capture;  // Cache headers and body of the current attempt
+    };
+    
+    Starter starter;
+    Aborter aborter;
+    size_t max_concurrent;
+    size_t active;
+    uint32_t next_id;
+    uint32_t now_ms;
+    uint32_t jitter_state;
+    bool processing;
+    std::list<Entry> entries;  // FIFO order within a priority
+    HttpCache cache;
+    
+    uint32_t allocate_id();
+    uint32_t backoff_delay(uint8_t attempt);
+    std::list<Entry>::iterator find_entry(uint32_t fetch_id);
+    void deliver_body(uint32_t fetch_id, std::string_view chunk);
+    void complete_fetch(uint32_t fetch_id, HttpError error, int status_code);
+    void start_entry(std::list<Entry>::iterator entry);
+    void start_ready(bool serve_from_cache);
+    void serve_cached(std::list<Entry>::iterator entry, std::string body);
+    static bool is_retryable(HttpError error, int status_code);
+};
@@ -0,0 +1,132 @@
+#include "sparkline.h"
+#include <algorithm>
+#include <cstring>
+
+Sparkline::Sparkline(int x, int y, int width, int height, ChartStyle style, RotationMode rotation)
+    : x(x)
+    , y(y)
+    , width(width)
+    , height(height)
+    , style(style)
+    , rotation(rotation)
+    , r(255)
+    , g(255)
+    , b(255)
+    , columns(width, Column{ -1, -1 })
+    , source_id(-1)
+    , sequence(0)
+    , from_values(false)
+    , scale_min(0.0f)
+    , scale_max(0.0f) {
+}
+
+void Sparkline::set_color(uint8_t r, uint8_t g, uint8_t b) {
+    this->r = r;
+    this->g = g;
+    this->b = b;
+}
+
+// Row for a value on the current scale, 0 = top; a flat series sits in the middle
+int Sparkline::row_of(float value) const {
+    if (scale_max <= scale_min) {
+        return height / 2;
+    }
+    int row = (height - 1) - (int)((value - scale_min) * (height - 1) / (scale_max - scale_min) + 0.5f);
+    return std::max(0, std::min(height - 1, row));
+}
+
+Sparkline::Column Sparkline::column_for(float previous, float value, bool has_previous) const {
+    int row = row_of(value);
+    if (style == ChartStyle::AREA) {
+        return Column{ (int8_t)row, (int8_t)(height - 1) };
+    }
+    
+    // Line: cover the rows between the previous sample and this one
+    int previous_row = has_previous ? row_of(previous) : row;
+    return Column{ (int8_t)std::min(row, previous_row), (int8_t)std::max(row, previous_row) };
+}
+
+void Sparkline::layout(const PriceSeries& series) {
+    size_t shown = std::min(series.size(), (size_t)width);
+    size_t first = series.size() - shown;
+    int empty = width - (int)shown;
+    
+    // Short series are right-aligned, like a chart that has just started
+    for (int i = 0; i < empty; i++) {
+        columns[i] = Column{ -1, -1 };
+    }
+    for (size_t i = 0; i < shown; i++) {
+        size_t index = first + i;
+        columns[empty + i] = column_for(index ? series.at(index - 1) : 0.0f, series.at(index), index > 0);
+    }
+}
+
+void Sparkline::update(const PriceSeries& series, int source_id) {
+    bool same_source = !from_values && source_id == this->source_id;
+    if (same_source && series.get_sequence() == sequence) {
+        return;
+    }
+    
+    bool same_scale = series.min() == scale_min && series.max() == scale_max;
+    bool one_more = same_source && series.get_sequence() == sequence + 1;
+    scale_min = series.min();
+    scale_max = series.max();
+    
+    if (one_more && same_scale && series.size() >= 2) {
+        // Shift everything one column left and plot only the new sample
+        memmove(columns.data(), columns.data() + 1, (width - 1) * sizeof(Column));
+        columns[width - 1] = column_for(series.at(series.size() - 2), series.latest(), true);
+    } else {
+        layout(series);
+    }
+    
+    this->source_id = source_id;
+    sequence = series.get_sequence();
+    from_values = false;
+}
+
+void Sparkline::layout(const float* values, size_t count) {
+    size_t shown = std::min(count, (size_t)width);
+    size_t first = count - shown;
+    int empty = width - (int)shown;
+    
+    for (int i = 0; i < empty; i++) {
+        columns[i] = Column{ -1, -1 };
+    }
+    for (size_t i = 0; i < shown; i++) {
+        size_t index = first + i;
+        columns[empty + i] = column_for(index ? values[index - 1] : 0.0f, values[index], index > 0);
+    }
+}
+
+void Sparkline::update(const float* values, size_t count, int source_id, uint32_t version) {
+    if (from_values && source_id == this->source_id && version == sequence) {
+        return;
+    }
+    
+    // Scale over what is shown
+    size_t first = count - std::min(count, (size_t)width);
+    scale_min = count ? values[first] : 0.0f;
+    scale_max = scale_min;
+    for (size_t i = first; i < count; i++) {
+        scale_min = std::min(scale_min, values[i]);
+        scale_max = std::max(scale_max, values[i]);
+    }
+    
+    layout(values, count);
+    this->source_id = source_id;
+    sequence = version;
+    from_values = true;
+}
+
+void Sparkline::draw(RenderContext& ctx) const {
+    for (int i = 0; i < width; i++) {
+        const Column& column = columns[i];
+        if (column.top < 0) {
+            continue;
+        }
+        for (int row = column.top; row <= column.bottom; row++) {
+            draw_pixel_mode(ctx, x + i, y + row, r, g, b, rotation);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "../core/common.hpp"
+#include "time_series.h"
+
+enum class ChartStyle {
+    LINE,   // Joined line through the samples
+    AREA    // Filled down to the bottom of the chart
+};
+
+// Price chart over the latest samples of a PriceSeries, one column each
+// The plotted columns are kept between frames. A single new sample on an
+// unchanged scale shifts them left by one and computes only the new
+// column; the chart is laid out in full only for a new series, a new scale
+// or more than one new sample.
+class Sparkline {
+public:
+    Sparkline(int x, int y, int width, int height, ChartStyle style,
+              RotationMode rotation = RotationMode::HORIZONTAL_UPSIDE_DOWN);
+    
+    // Catch up with series. source_id names the series (e.g. asset index),
+    // so switching to another one starts over.
+    void update(const PriceSeries& series, int source_id);
+    
+    // Show count ready-made values (e.g. a downsampled rollup), the last
+    // width of them. Laid out again whenever source_id or version changes.
+    void update(const float* values, size_t count, int source_id, uint32_t version);
+    
+    void set_color(uint8_t r, uint8_t g, uint8_t b);
+    
+    void draw(RenderContext& ctx) const;
+    
+private:
+    struct Column {
+        int8_t top;              // First and last lit row, top = -1 for none
+        int8_t bottom;
+    };
+    
+    int x;
+    int y;
+    int width;
+    int height;
+    ChartStyle style;
+    RotationMode rotation;
+    uint8_t r, g, b;
+    
+    std::vector<Column> columns; // width entries, oldest on the left
+    int source_id;
+    uint32_t sequence;           // Series sequence (or values version) the columns show
+    bool from_values;            // Columns came from the values overload
+    float scale_min;
+    float scale_max;
+    
+    int row_of(float value) const;
+    Column column_for(float previous, float value, bool has_previous) const;
+    void layout(const PriceSeries& series);
+    void layout(const float* values, size_t count);
+};
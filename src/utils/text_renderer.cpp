@@ -1,9 +1,10 @@
 #include "text_renderer.h"
 #include "../core/common.hpp"
+#include "../core/DisplayList.hpp"
 #include "tiny_bitmap.h"
 
 // Render single character using bitmap font with rotation
-void draw_char_bitmap(int visual_x, int visual_y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_char_bitmap(RenderContext& ctx, int visual_x, int visual_y, char c, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
     const BitmapChar* char_bitmap = get_char_bitmap(c);
     if (!char_bitmap || !char_bitmap->data) {
         return; // Skip invalid characters
@@ -20,21 +21,27 @@ void draw_char_bitmap(int visual_x, int visual_y, char c, uint8_t r, uint8_t g,
                 int pixel_y = visual_y + y;
                 
                 // Use existing draw_pixel function which handles rotation
-                draw_pixel(pixel_x, pixel_y, r, g, b, rotate);
+                draw_pixel(ctx, pixel_x, pixel_y, r, g, b, rotate);
             }
         }
     }
 }
 
 // Render text string using bitmap font with Python-style coordinates
-void draw_text_bitmap(int visual_x, int visual_y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+void draw_text_bitmap(RenderContext& ctx, int visual_x, int visual_y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, bool rotate) {
+    // draw_pixel always rotates 180, whatever rotate says
+    if (DisplayList* list = ctx.get_recorder()) {
+        list->text(visual_x, visual_y, text, r, g, b, RotationMode::HORIZONTAL_UPSIDE_DOWN);
+        return;
+    }
+    
     int current_x = visual_x;
     
     for (char c : text) {
         const BitmapChar* char_bitmap = get_char_bitmap(c);
         if (char_bitmap) {
             // Draw the character
-            draw_char_bitmap(current_x, visual_y, c, r, g, b, rotate);
+            draw_char_bitmap(ctx, current_x, visual_y, c, r, g, b, rotate);
             
             // Advance cursor by character width + 1px spacing
             current_x += char_bitmap->width + 1;
@@ -43,24 +50,24 @@ void draw_text_bitmap(int visual_x, int visual_y, const std::string& text, uint8
 }
 
 // Convenience functions for weather app colors
-void draw_text_white(int x, int y, const std::string& text, bool rotate) {
-    draw_text_bitmap(x, y, text, 255, 255, 255, rotate);
+void draw_text_white(RenderContext& ctx, int x, int y, const std::string& text, bool rotate) {
+    draw_text_bitmap(ctx, x, y, text, 255, 255, 255, rotate);
 }
 
-void draw_text_blue(int x, int y, const std::string& text, bool rotate) {
-    draw_text_bitmap(x, y, text, 100, 150, 255, rotate);
+void draw_text_blue(RenderContext& ctx, int x, int y, const std::string& text, bool rotate) {
+    draw_text_bitmap(ctx, x, y, text, 100, 150, 255, rotate);
 }
 
-void draw_text_red(int x, int y, const std::string& text, bool rotate) {
-    draw_text_bitmap(x, y, text, 255, 100, 100, rotate);
+void draw_text_red(RenderContext& ctx, int x, int y, const std::string& text, bool rotate) {
+    draw_text_bitmap(ctx, x, y, text, 255, 100, 100, rotate);
 }
 
-void draw_text_yellow(int x, int y, const std::string& text, bool rotate) {
-    draw_text_bitmap(x, y, text, 255, 255, 0, rotate);
+void draw_text_yellow(RenderContext& ctx, int x, int y, const std::string& text, bool rotate) {
+    draw_text_bitmap(ctx, x, y, text, 255, 255, 0, rotate);
 }
 
 // New rotation mode text rendering functions
-void draw_char_bitmap_mode(int visual_x, int visual_y, char c, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+void draw_char_bitmap_mode(RenderContext& ctx, int visual_x, int visual_y, char c, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
     const BitmapChar* char_bitmap = get_char_bitmap(c);
     if (!char_bitmap || !char_bitmap->data) {
         return; // Skip invalid characters
@@ -77,20 +84,25 @@ void draw_char_bitmap_mode(int visual_x, int visual_y, char c, uint8_t r, uint8_
                 int pixel_y = visual_y + y;
                 
                 // Use new draw_pixel_mode function which handles rotation
-                draw_pixel_mode(pixel_x, pixel_y, r, g, b, rotation);
+                draw_pixel_mode(ctx, pixel_x, pixel_y, r, g, b, rotation);
             }
         }
     }
 }
 
-void draw_text_bitmap_mode(int visual_x, int visual_y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+void draw_text_bitmap_mode(RenderContext& ctx, int visual_x, int visual_y, const std::string& text, uint8_t r, uint8_t g, uint8_t b, RotationMode rotation) {
+    if (DisplayList* list = ctx.get_recorder()) {
+        list->text(visual_x, visual_y, text, r, g, b, rotation);
+        return;
+    }
+    
     int current_x = visual_x;
     
     for (char c : text) {
         const BitmapChar* char_bitmap = get_char_bitmap(c);
         if (char_bitmap) {
             // Draw the character
-            draw_char_bitmap_mode(current_x, visual_y, c, r, g, b, rotation);
+            draw_char_bitmap_mode(ctx, current_x, visual_y, c, r, g, b, rotation);
             
             // Advance cursor by character width + 1px spacing
             current_x += char_bitmap->width + 1;
@@ -99,20 +111,20 @@ void draw_text_bitmap_mode(int visual_x, int visual_y, const std::string& text,
 }
 
 // New rotation mode convenience functions for weather app colors
-void draw_text_white_mode(int x, int y, const std::string& text, RotationMode rotation) {
-    draw_text_bitmap_mode(x, y, text, 255, 255, 255, rotation);
+void draw_text_white_mode(RenderContext& ctx, int x, int y, const std::string& text, RotationMode rotation) {
+    draw_text_bitmap_mode(ctx, x, y, text, 255, 255, 255, rotation);
 }
 
-void draw_text_blue_mode(int x, int y, const std::string& text, RotationMode rotation) {
-    draw_text_bitmap_mode(x, y, text, 100, 150, 255, rotation);
+void draw_text_blue_mode(RenderContext& ctx, int x, int y, const std::string& text, RotationMode rotation) {
+    draw_text_bitmap_mode(ctx, x, y, text, 100, 150, 255, rotation);
 }
 
-void draw_text_red_mode(int x, int y, const std::string& text, RotationMode rotation) {
-    draw_text_bitmap_mode(x, y, text, 255, 100, 100, rotation);
+void draw_text_red_mode(RenderContext& ctx, int x, int y, const std::string& text, RotationMode rotation) {
+    draw_text_bitmap_mode(ctx, x, y, text, 255, 100, 100, rotation);
 }
 
-void draw_text_yellow_mode(int x, int y, const std::string& text, RotationMode rotation) {
-    draw_text_bitmap_mode(x, y, text, 255, 255, 0, rotation);
+void draw_text_yellow_mode(RenderContext& ctx, int x, int y, const std::string& text, RotationMode rotation) {
+    draw_text_bitmap_mode(ctx, x, y, text, 255, 255, 0, rotation);
 }
 
 // Calculate text width for layout purposes
@@ -132,4 +144,33 @@ int measure_text_width(const std::string& text) {
     }
     
     return total_width;
+}
+
+int rasterize_text_columns(const std::string& text, std::vector<uint8_t>& columns) {
+    columns.clear();
+    
+    for (char c : text) {
+        const BitmapChar* char_bitmap = get_char_bitmap(c);
+        if (!char_bitmap || !char_bitmap->data) {
+            continue;
+        }
+        
+        for (int x = 0; x < char_bitmap->width; x++) {
+            uint8_t column = 0;
+            for (int y = 0; y < char_bitmap->height && y < 8; y++) {
+                if (char_bitmap->data[y] & (1 << (7 - x))) {
+                    column |= 1 << y;
+                }
+            }
+            columns.push_back(column);
+        }
+        columns.push_back(0); // 1px spacing
+    }
+    
+    // Remove trailing spacing
+    if (!columns.empty()) {
+        columns.pop_back();
+    }
+    
+    return (int)columns.size();
 }
\ No newline at end of file
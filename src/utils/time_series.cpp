@@ -0,0 +1,209 @@
+#include "time_series.h"
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+PriceSeries::PriceSeries() {
+    clear();
+}
+
+void PriceSeries::clear() {
+    count = 0;
+    sequence = 0;
+    min_queue.head = 0;
+    min_queue.length = 0;
+    max_queue.head = 0;
+    max_queue.length = 0;
+}
+
+float PriceSeries::at(size_t index) const {
+    if (index >= count) {
+        return 0.0f;
+    }
+    return value_of(sequence - count + index);
+}
+
+float PriceSeries::min() const {
+    return min_queue.length ? value_of(min_queue.entries[min_queue.head]) : 0.0f;
+}
+
+float PriceSeries::max() const {
+    return max_queue.length ? value_of(max_queue.entries[max_queue.head]) : 0.0f;
+}
+
+// Drop candidates that left the window or can never win again, then queue
+// the new sample. Each sample is queued and dropped once - O(1) amortised.
+void PriceSeries::update_queue(Queue& queue, float value, bool keep_smaller) {
+    // The oldest sample in the window is about to be overwritten
+    if (queue.length && sequence - queue.entries[queue.head] >= PRICE_SERIES_SAMPLES) {
+        queue.head = (queue.head + 1) % PRICE_SERIES_SAMPLES;
+        queue.length--;
+    }
+    
+    while (queue.length) {
+        size_t tail = (queue.head + queue.length - 1) % PRICE_SERIES_SAMPLES;
+        float candidate = value_of(queue.entries[tail]);
+        if (keep_smaller ? candidate < value : candidate > value) {
+            break;
+        }
+        queue.length--;
+    }
+    
+    queue.entries[(queue.head + queue.length) % PRICE_SERIES_SAMPLES] = sequence;
+    queue.length++;
+}
+
+void PriceSeries::push(float value) {
+    // Queues first: they still need the value being overwritten
+    update_queue(min_queue, value, true);
+    update_queue(max_queue, value, false);
+    
+    samples[sequence % PRICE_SERIES_SAMPLES] = value;
+    sequence++;
+    if (count < PRICE_SERIES_SAMPLES) {
+        count++;
+    }
+}
+
+float parse_price(const std::string& text) {
+    const char* start = text.c_str();
+    while (*start == '$' || *start == ' ') {
+        start++;
+    }
+    
+    char* end = nullptr;
+    float value = strtof(start, &end);
+    if (end == start) {
+        return 0.0f;
+    }
+    
+    switch (*end) {
+        case 'K': case 'k': return value * 1e3f;
+        case 'M': case 'm': return value * 1e6f;
+        case 'B': case 'b': return value * 1e9f;
+        default: return value;
+    }
+}
+
+// Bucket length of each rollup level, finest first
+static const uint32_t ROLLUP_PERIODS_S[] = { 60, 5 * 60, 60 * 60, 24 * 60 * 60 };
+
+OhlcRollup::OhlcRollup() {
+    for (Level& level : levels) {
+        level.bucket = 0;
+        level.sequence = 0;
+        level.count = 0;
+    }
+}
+
+const OhlcRollup::Level* OhlcRollup::level_for(Timeframe timeframe) const {
+    int index = (int)timeframe - (int)Timeframe::MINUTE;
+    if (index < 0 || index >= LEVELS) {
+        return nullptr;
+    }
+    return &levels[index];
+}
+
+void OhlcRollup::add(float price, uint32_t time_s) {
+    for (int i = 0; i < LEVELS; i++) {
+        Level& level = levels[i];
+        uint32_t bucket = time_s / ROLLUP_PERIODS_S[i];
+        
+        // Same bucket (or a clock that stepped back): extend the open bar
+        if (level.count && bucket <= level.bucket) {
+            OhlcBar& bar = level.bars[(level.sequence - 1) % ROLLUP_BARS];
+            bar.high = std::max(bar.high, price);
+            bar.low = std::min(bar.low, price);
+            bar.close = price;
+            continue;
+        }
+        
+        // New bucket: start a bar over the oldest one
+        level.bars[level.sequence % ROLLUP_BARS] = OhlcBar{ price, price, price, price };
+        level.bucket = bucket;
+        level.sequence++;
+        if (level.count < ROLLUP_BARS) {
+            level.count++;
+        }
+    }
+}
+
+size_t OhlcRollup::size(Timeframe timeframe) const {
+    const Level* level = level_for(timeframe);
+    return level ? level->count : 0;
+}
+
+const OhlcBar& OhlcRollup::bar(Timeframe timeframe, size_t index) const {
+    static const OhlcBar none = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const Level* level = level_for(timeframe);
+    if (!level || index >= level->count) {
+        return none;
+    }
+    return level->bars[(level->sequence - level->count + index) % ROLLUP_BARS];
+}
+
+size_t OhlcRollup::downsample(Timeframe timeframe, float* out, size_t points) const {
+    size_t total = size(timeframe);
+    
+    // Nothing to drop: the closes as they are (the latest ones if points < 3)
+    if (total <= points || points < 3) {
+        size_t shown = std::min(total, points);
+        for (size_t i = 0; i < shown; i++) {
+            out[i] = bar(timeframe, total - shown + i).close;
+        }
+        return shown;
+    }
+    
+    // Inner bars split into points - 2 buckets; first and last bar always kept
+    float every = (float)(total - 2) / (float)(points - 2);
+    size_t selected = 0;
+    out[0] = bar(timeframe, 0).close;
+    
+    for (size_t i = 0; i < points - 2; i++) {
+        // Average of the next bucket - the third corner of the triangle
+        size_t next_start = (size_t)((i + 1) * every) + 1;
+        size_t next_end = std::min((size_t)((i + 2) * every) + 1, total);
+        float average_x = 0.0f;
+        float average_y = 0.0f;
+        for (size_t j = next_start; j < next_end; j++) {
+            average_x += (float)j;
+            average_y += bar(timeframe, j).close;
+        }
+        size_t next_count = next_end - next_start;
+        average_x /= (float)next_count;
+        average_y /= (float)next_count;
+        
+        // Bar of this bucket spanning the largest triangle with the last pick
+        size_t start = (size_t)(i * every) + 1;
+        size_t end = (size_t)((i + 1) * every) + 1;
+        float selected_y = bar(timeframe, selected).close;
+        float largest = -1.0f;
+        size_t best = start;
+        for (size_t j = start; j < end; j++) {
+            float y = bar(timeframe, j).close;
+            float area = std::fabs(((float)selected - average_x) * (y - selected_y) -
+                                   ((float)selected - (float)j) * (average_y - selected_y));
+            if (area > largest) {
+                largest = area;
+                best = j;
+            }
+        }
+        
+        out[i + 1] = bar(timeframe, best).close;
+        selected = best;
+    }
+    
+    out[points - 1] = bar(timeframe, total - 1).close;
+    return points;
+}
+
+const char* get_timeframe_name(Timeframe timeframe) {
+    switch (timeframe) {
+        case Timeframe::TICKS: return "LIVE";
+        case Timeframe::MINUTE: return "1M";
+        case Timeframe::FIVE_MINUTES: return "5M";
+        case Timeframe::HOUR: return "1H";
+        case Timeframe::DAY: return "1D";
+        default: return "?";
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Samples kept per asset - one per column of the widest chart, with room to spare
+#define PRICE_SERIES_SAMPLES 64
+
+// Fixed-size window of the latest price samples
+// Old samples are overwritten, so memory stays the same however long the
+// device runs. Minimum and maximum over the window are kept up to date on
+// every push (monotonic queues), so charts can scale without a scan.
+class PriceSeries {
+public:
+    PriceSeries();
+    
+    void push(float value);
+    void clear();
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    // index 0 = oldest sample in the window, size() - 1 = latest
+    float at(size_t index) const;
+    float latest() const { return at(count - 1); }
+    
+    float min() const;
+    float max() const;
+    
+    // Samples pushed so far (wraps) - changes with every push
+    uint32_t get_sequence() const { return sequence; }
+    
+private:
+    float samples[PRICE_SERIES_SAMPLES];
+    size_t count;
+    uint32_t sequence;           // Sample n lives in samples[n % PRICE_SERIES_SAMPLES]
+    
+    // Sequence numbers of the candidates for min and max, oldest first
+    struct Queue {
+        uint32_t entries[PRICE_SERIES_SAMPLES];
+        size_t head;
+        size_t length;
+    };
+    Queue min_queue;
+    Queue max_queue;
+    
+    float value_of(uint32_t sample) const { return samples[sample % PRICE_SERIES_SAMPLES]; }
+    void update_queue(Queue& queue, float value, bool keep_smaller);
+};
+
+// "245.30", "98.5K", "1.2M" -> float (0 if not a number)
+float parse_price(const std::string& text);
+
+// Bars kept per rollup resolution
+#define ROLLUP_BARS 72
+
+// What a price chart plots
+enum class Timeframe : uint8_t {
+    TICKS,          // Raw samples (PriceSeries)
+    MINUTE,         // 1 minute bars, 72 minutes
+    FIVE_MINUTES,   // 5 minute bars, 6 hours
+    HOUR,           // 1 hour bars, 3 days
+    DAY,            // 1 day bars, about 10 weeks
+    COUNT
+};
+
+struct OhlcBar {
+    float open;
+    float high;
+    float low;
+    float close;
+};
+
+// Open/high/low/close bars of one asset at every resolution at once
+// Each sample is folded into the open bar of every level, so adding one costs
+// the same however much history there is, and every timeframe is ready to
+// draw without going back over raw samples. Memory is fixed: ROLLUP_BARS per
+// level, the oldest bar overwritten when a new bucket starts.
+class OhlcRollup {
+public:
+    OhlcRollup();
+    
+    // Fold in a price seen at time_s (seconds, any fixed origin)
+    void add(float price, uint32_t time_s);
+    
+    // Bars at a resolution, index 0 = oldest. TICKS has none.
+    size_t size(Timeframe timeframe) const;
+    const OhlcBar& bar(Timeframe timeframe, size_t index) const;
+    
+    // Largest-Triangle-Three-Buckets over the closes: at most points values,
+    // first and last bar kept, the rest the most shape-preserving bar of each
+    // bucket. Returns how many were written to out.
+    size_t downsample(Timeframe timeframe, float* out, size_t points) const;
+    
+private:
+    static constexpr int LEVELS = 4;
+    
+    struct Level {
+        OhlcBar bars[ROLLUP_BARS];
+        uint32_t bucket;         // time_s / period of the newest bar
+        uint32_t sequence;       // Bars started so far; bar n lives in bars[n % ROLLUP_BARS]
+        size_t count;
+    };
+    Level levels[LEVELS];
+    
+    const Level* level_for(Timeframe timeframe) const;
+};
+
+// Short label for a timeframe ("1M", "1D" ...)
+const char* get_timeframe_name(Timeframe timeframe);
@@ -0,0 +1,149 @@
+#include "tls_memory.h"
+#include "mbedtls/platform.h"
+#include <cstring>
+
+// Block header. Allocated blocks only use size; free blocks also link to the
+// next free block in address order so neighbours can be merged on free.
+struct ArenaBlock {
+    size_t size;        // Whole block including this header
+    ArenaBlock* next;
+};
+
+#define ARENA_ALIGN 8
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_MIN_BLOCK (ARENA_HEADER + ARENA_ALIGN)
+
+alignas(ARENA_ALIGN) static uint8_t arena[TLS_ARENA_SIZE];
+static ArenaBlock* free_list = nullptr;
+static bool initialized = false;
+
+static size_t current_bytes = 0;
+static size_t peak_bytes = 0;
+static size_t current_blocks = 0;
+static size_t peak_blocks = 0;
+static uint32_t failed_allocs = 0;
+
+static void* arena_calloc(size_t count, size_t size) {
+    if (count != 0 && size > SIZE_MAX / count) {
+        failed_allocs++;
+        return nullptr;
+    }
+    size_t bytes = count * size;
+    if (bytes > TLS_ARENA_SIZE) {
+        failed_allocs++;
+        return nullptr;
+    }
+    
+    size_t need = (bytes + ARENA_HEADER + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (need < ARENA_MIN_BLOCK) {
+        need = ARENA_MIN_BLOCK;
+    }
+    
+    // First fit - mbedTLS allocates in a fairly fixed pattern per handshake,
+    // so low blocks get reused and the top of the arena stays contiguous
+    ArenaBlock** link = &free_list;
+    while (*link && (*link)->size < need) {
+        link = &(*link)->next;
+    }
+    ArenaBlock* block = *link;
+    if (block == nullptr) {
+        failed_allocs++;
+        return nullptr;
+    }
+    
+    if (block->size - need >= ARENA_MIN_BLOCK) {
+        // Split off the tail as a new free block
+        ArenaBlock* rest = (ArenaBlock*)((uint8_t*)block + need);
+        rest->size = block->size - need;
+        rest->next = block->next;
+        *link = rest;
+        block->size = need;
+    } else {
+        *link = block->next;
+    }
+    
+    current_bytes += block->size;
+    current_blocks++;
+    if (current_bytes > peak_bytes) {
+        peak_bytes = current_bytes;
+    }
+    if (current_blocks > peak_blocks) {
+        peak_blocks = current_blocks;
+    }
+    
+    void* payload = (uint8_t*)block + ARENA_HEADER;
+    memset(payload, 0, block->size - ARENA_HEADER);
+    return payload;
+}
+
+static void arena_free(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    
+    ArenaBlock* block = (ArenaBlock*)((uint8_t*)ptr - ARENA_HEADER);
+    current_bytes -= block->size;
+    current_blocks--;
+    
+    // Insert in address order
+    ArenaBlock* prev = nullptr;
+    ArenaBlock* next = free_list;
+    while (next && next < block) {
+        prev = next;
+        next = next->next;
+    }
+    
+    // Merge with the following block
+    block->next = next;
+    if (next && (uint8_t*)block + block->size == (uint8_t*)next) {
+        block->size += next->size;
+        block->next = next->next;
+    }
+    
+    // Merge with the preceding block
+    if (prev && (uint8_t*)prev + prev->size == (uint8_t*)block) {
+        prev->size += block->size;
+        prev->next = block->next;
+    } else if (prev) {
+        prev->next = block;
+    } else {
+        free_list = block;
+    }
+}
+
+void tls_memory_init() {
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+    
+    free_list = (ArenaBlock*)arena;
+    free_list->size = TLS_ARENA_SIZE;
+    free_list->next = nullptr;
+    
+    mbedtls_platform_set_calloc_free(arena_calloc, arena_free);
+}
+
+TlsMemoryStats tls_memory_stats() {
+    TlsMemoryStats stats;
+    stats.arena_size = TLS_ARENA_SIZE;
+    stats.current_bytes = current_bytes;
+    stats.peak_bytes = peak_bytes;
+    stats.current_blocks = current_blocks;
+    stats.peak_blocks = peak_blocks;
+    stats.failed_allocs = failed_allocs;
+    
+    size_t largest = 0;
+    for (ArenaBlock* block = free_list; block; block = block->next) {
+        if (block->size > largest) {
+            largest = block->size;
+        }
+    }
+    stats.largest_free = largest > ARENA_HEADER ? largest - ARENA_HEADER : 0;
+    return stats;
+}
+
+void tls_memory_reset_peak() {
+    peak_bytes = current_bytes;
+    peak_blocks = current_blocks;
+}
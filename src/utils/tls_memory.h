@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed arena for every mbedTLS allocation. Sized for HTTPS_MAX_CONNECTIONS
+// open connections (record buffers shrink to the negotiated fragment length
+// after the handshake) plus one handshake's certificate and key exchange state
+#define TLS_ARENA_SIZE (80 * 1024)
+
+struct TlsMemoryStats {
+    size_t arena_size;
+    size_t current_bytes;    // Allocated now, including block headers
+    size_t peak_bytes;       // High-water mark since boot or the last reset
+    size_t current_blocks;
+    size_t peak_blocks;
+    size_t largest_free;     // Biggest single allocation that would still fit
+    uint32_t failed_allocs;  // Requests the arena could not satisfy
+};
+
+// Route mbedTLS allocations into the arena - call before any TLS object is
+// created. Safe to call more than once.
+void tls_memory_init();
+
+// Current usage and high-water marks
+TlsMemoryStats tls_memory_stats();
+
+// Restart peak tracking (e.g. before measuring one handshake)
+void tls_memory_reset_peak();
@@ -0,0 +1,303 @@
+#include "tls_session_cache.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <cstring>
+#include <cstdio>
+
+// Sessions live in the last sector of flash, well past the firmware image
+#define TLS_SESSION_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define TLS_SESSION_FLASH_MAGIC 0x53534C54u  // "TLSS"
+#define TLS_SESSION_FLASH_VERSION 2
+
+// Sector image: header, then per entry host length, host, remaining lifetime
+// in seconds, session length, session
+struct SessionFlashHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+};
+
+// Staging buffer for one flash sector - static so it is not on the stack
+static uint8_t flash_image[FLASH_SECTOR_SIZE];
+
+static uint32_t now_ms() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+TlsSessionCache::TlsSessionCache()
+    : dirty(false)
+    , purge_pending(false)
+    , last_flash_write_ms(0)
+    , offered_count(0)
+    , stored_count(0) {
+    for (Entry& entry : entries) {
+        entry.host[0] = '\0';
+        entry.valid = false;
+        entry.last_used_ms = 0;
+        entry.expires_ms = 0;
+        mbedtls_ssl_session_init(&entry.session);
+    }
+}
+
+TlsSessionCache::~TlsSessionCache() {
+    for (Entry& entry : entries) {
+        mbedtls_ssl_session_free(&entry.session);
+    }
+}
+
+TlsSessionCache::Entry* TlsSessionCache::find(const std::string& host) {
+    for (Entry& entry : entries) {
+        if (entry.valid && host == entry.host) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+TlsSessionCache::Entry* TlsSessionCache::find_slot(const std::string& host) {
+    Entry* existing = find(host);
+    if (existing) {
+        return existing;
+    }
+    
+    // Free slot, otherwise the least recently used session
+    Entry* oldest = &entries[0];
+    for (Entry& entry : entries) {
+        if (!entry.valid) {
+            return &entry;
+        }
+        if ((int32_t)(entry.last_used_ms - oldest->last_used_ms) < 0) {
+            oldest = &entry;
+        }
+    }
+    return oldest;
+}
+
+void TlsSessionCache::clear_entry(Entry& entry) {
+    mbedtls_ssl_session_free(&entry.session);
+    mbedtls_ssl_session_init(&entry.session);
+    entry.host[0] = '\0';
+    entry.valid = false;
+}
+
+// Drop sessions whose lifetime is over, and have flash rewritten without them
+void TlsSessionCache::expire(uint32_t now_ms) {
+    for (Entry& entry : entries) {
+        if (entry.valid && (int32_t)(now_ms - entry.expires_ms) >= 0) {
+            printf("TLS session for %s expired\n", entry.host);
+            clear_entry(entry);
+            dirty = true;
+            purge_pending = true;
+        }
+    }
+}
+
+bool TlsSessionCache::apply(const std::string& host, mbedtls_ssl_context* ssl) {
+    expire(now_ms());
+    Entry* entry = find(host);
+    if (entry == nullptr || ssl == nullptr) {
+        return false;
+    }
+    
+    // mbedTLS copies the session, so the cached one stays ours
+    int ret = mbedtls_ssl_set_session(ssl, &entry->session);
+    if (ret != 0) {
+        printf("TLS session for %s rejected: -0x%04x\n", host.c_str(), -ret);
+        clear_entry(*entry);
+        dirty = true;
+        return false;
+    }
+    
+    entry->last_used_ms = now_ms();
+    offered_count++;
+    return true;
+}
+
+void TlsSessionCache::store(const std::string& host, mbedtls_ssl_context* ssl) {
+    if (ssl == nullptr || host.length() > TLS_SESSION_MAX_HOST) {
+        return;
+    }
+    
+    Entry* entry = find_slot(host);
+    clear_entry(*entry);
+    
+    int ret = mbedtls_ssl_get_session(ssl, &entry->session);
+    if (ret != 0) {
+        printf("TLS session for %s not saved: -0x%04x\n", host.c_str(), -ret);
+        clear_entry(*entry);
+        return;
+    }
+    
+    // Ticket lifetime as announced by the server (0 = no ticket)
+    uint32_t lifetime_s = 0;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    lifetime_s = entry->session.MBEDTLS_PRIVATE(ticket_lifetime);
+#endif
+    if (lifetime_s == 0) {
+        lifetime_s = TLS_SESSION_DEFAULT_LIFETIME_S;
+    }
+    
+    strncpy(entry->host, host.c_str(), TLS_SESSION_MAX_HOST);
+    entry->host[TLS_SESSION_MAX_HOST] = '\0';
+    entry->valid = true;
+    entry->last_used_ms = now_ms();
+    entry->expires_ms = entry->last_used_ms + lifetime_s * 1000;
+    stored_count++;
+    dirty = true;
+}
+
+void TlsSessionCache::forget(const std::string& host) {
+    Entry* entry = find(host);
+    if (entry) {
+        clear_entry(*entry);
+        dirty = true;
+    }
+}
+
+bool TlsSessionCache::load_from_flash() {
+#if TLS_SESSION_PERSIST_FLASH
+    const uint8_t* sector = (const uint8_t*)(XIP_BASE + TLS_SESSION_FLASH_OFFSET);
+    
+    SessionFlashHeader header;
+    memcpy(&header, sector, sizeof(header));
+    if (header.magic != TLS_SESSION_FLASH_MAGIC || header.version != TLS_SESSION_FLASH_VERSION) {
+        return false;  // Blank sector or an older layout
+    }
+    
+    size_t offset = sizeof(header);
+    int loaded = 0;
+    for (uint16_t i = 0; i < header.count && i < TLS_SESSION_CACHE_SIZE; i++) {
+        if (offset + 1 > FLASH_SECTOR_SIZE) {
+            break;
+        }
+        uint8_t host_len = sector[offset++];
+        if (host_len > TLS_SESSION_MAX_HOST || offset + host_len + 2 > FLASH_SECTOR_SIZE) {
+            break;
+        }
+        const char* host = (const char*)&sector[offset];
+        offset += host_len;
+        
+        uint32_t remaining_s;
+        if (offset + sizeof(remaining_s) + 2 > FLASH_SECTOR_SIZE) {
+            break;
+        }
+        memcpy(&remaining_s, &sector[offset], sizeof(remaining_s));
+        offset += sizeof(remaining_s);
+        
+        uint16_t session_len;
+        memcpy(&session_len, &sector[offset], sizeof(session_len));
+        offset += sizeof(session_len);
+        if (session_len > TLS_SESSION_MAX_SAVED || offset + session_len > FLASH_SECTOR_SIZE) {
+            break;
+        }
+        
+        Entry& entry = entries[loaded];
+        clear_entry(entry);
+        if (mbedtls_ssl_session_load(&entry.session, &sector[offset], session_len) == 0) {
+            memcpy(entry.host, host, host_len);
+            entry.host[host_len] = '\0';
+            entry.valid = true;
+            entry.last_used_ms = 0;
+            entry.expires_ms = now_ms() + remaining_s * 1000;
+            loaded++;
+        } else {
+            clear_entry(entry);
+        }
+        offset += session_len;
+    }
+    
+    printf("TLS session cache: restored %d session(s) from flash\n", loaded);
+    return loaded > 0;
+#else
+    return false;
+#endif
+}
+
+#if TLS_SESSION_PERSIST_FLASH
+static void program_session_sector(void* param) {
+    (void)param;
+    flash_range_erase(TLS_SESSION_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(TLS_SESSION_FLASH_OFFSET, flash_image, FLASH_SECTOR_SIZE);
+}
+#endif
+
+bool TlsSessionCache::save_to_flash() {
+#if TLS_SESSION_PERSIST_FLASH
+    memset(flash_image, 0xFF, sizeof(flash_image));
+    
+    SessionFlashHeader header = { TLS_SESSION_FLASH_MAGIC, TLS_SESSION_FLASH_VERSION, 0 };
+    size_t offset = sizeof(header);
+    
+    // Only what is left of each lifetime is written, so a restored session
+    // never outlives its ticket by more than the time spent powered off
+    uint32_t now = now_ms();
+    expire(now);
+    
+    for (Entry& entry : entries) {
+        if (!entry.valid) {
+            continue;
+        }
+        
+        uint8_t host_len = (uint8_t)strlen(entry.host);
+        uint32_t remaining_s = (entry.expires_ms - now) / 1000;
+        size_t session_start = offset + 1 + host_len + sizeof(remaining_s) + sizeof(uint16_t);
+        if (session_start + TLS_SESSION_MAX_SAVED > FLASH_SECTOR_SIZE) {
+            break;
+        }
+        
+        size_t session_len = 0;
+        if (mbedtls_ssl_session_save(&entry.session, &flash_image[session_start],
+                                     TLS_SESSION_MAX_SAVED, &session_len) != 0) {
+            continue;  // Too large (e.g. a huge ticket) - stays RAM only
+        }
+        
+        flash_image[offset++] = host_len;
+        memcpy(&flash_image[offset], entry.host, host_len);
+        offset += host_len;
+        memcpy(&flash_image[offset], &remaining_s, sizeof(remaining_s));
+        offset += sizeof(remaining_s);
+        uint16_t stored_len = (uint16_t)session_len;
+        memcpy(&flash_image[offset], &stored_len, sizeof(stored_len));
+        offset += sizeof(stored_len) + session_len;
+        header.count++;
+    }
+    memcpy(flash_image, &header, sizeof(header));
+    
+    // Erasing stalls XIP, so the other core (if running) must be parked
+    int rc = flash_safe_execute(program_session_sector, nullptr, 100);
+    
+    // The image holds session secrets - do not leave a copy in RAM
+    memset(flash_image, 0, sizeof(flash_image));
+    
+    if (rc != PICO_OK) {
+        printf("TLS session cache: flash write failed: %d\n", rc);
+        return false;
+    }
+    
+    dirty = false;
+    purge_pending = false;
+    last_flash_write_ms = now_ms();
+    printf("TLS session cache: saved %d session(s) to flash\n", header.count);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TlsSessionCache::process(uint32_t now_ms) {
+    expire(now_ms);
+    
+#if TLS_SESSION_PERSIST_FLASH
+    if (!dirty) {
+        return;
+    }
+    
+    // First write after boot goes out straight away, later ones are spaced -
+    // except to purge an expired session, which must not linger in flash
+    if (!purge_pending && last_flash_write_ms != 0 &&
+        now_ms - last_flash_write_ms < TLS_SESSION_FLASH_INTERVAL_MS) {
+        return;
+    }
+    save_to_flash();
+#endif
+}
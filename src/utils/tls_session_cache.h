@@ -0,0 +1,88 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "mbedtls/ssl.h"
+#include <string>
+#include <cstdint>
+
+// Resumable sessions kept in RAM - one per API host the apps talk to
+#define TLS_SESSION_CACHE_SIZE 4
+
+// Longest host name that gets a cache slot
+#define TLS_SESSION_MAX_HOST 63
+
+// Largest serialized session (state + ticket) that is persisted to flash
+#define TLS_SESSION_MAX_SAVED 768
+
+// Keep sessions across reboots in the last flash sector (0 = RAM only)
+// Off by default: the sector holds each host's session ID, master secret and
+// ticket in the clear, so anyone who can dump the flash can resume those
+// sessions or decrypt traffic captured on them. A session is purged from
+// flash once its ticket lifetime is used up - counted in uptime, as time
+// spent powered off is unknown without a clock.
+#ifndef TLS_SESSION_PERSIST_FLASH
+#define TLS_SESSION_PERSIST_FLASH 0
+#endif
+
+// Lifetime of a session the server issued no ticket for (session ID only)
+#define TLS_SESSION_DEFAULT_LIFETIME_S (60 * 60)
+
+// Changed sessions are written back at most this often to spare the sector
+#define TLS_SESSION_FLASH_INTERVAL_MS (60 * 60 * 1000)
+
+// Client-side TLS session cache
+// The session (ID + master secret, and the ticket when the server issues one)
+// from every completed handshake is kept per host. The next connection to the
+// host offers it, so the server can skip the certificate exchange and the
+// RSA/ECDHE key exchange - an abbreviated handshake is one round trip and no
+// public-key operations. A server that does not resume simply falls back to a
+// full handshake.
+class TlsSessionCache {
+public:
+    TlsSessionCache();
+    ~TlsSessionCache();
+    
+    // Offer the cached session for host - call after SNI, before connecting
+    // Returns true if a session was offered
+    bool apply(const std::string& host, mbedtls_ssl_context* ssl);
+    
+    // Remember the session of a completed handshake
+    void store(const std::string& host, mbedtls_ssl_context* ssl);
+    
+    // Drop the session for host (e.g. the handshake that offered it failed)
+    void forget(const std::string& host);
+    
+    // Restore sessions saved by a previous boot
+    bool load_from_flash();
+    
+    // Write sessions to flash now
+    bool save_to_flash();
+    
+    // Write changed sessions back to flash, rate limited (call in main loop)
+    void process(uint32_t now_ms);
+    
+    // Handshake metrics
+    uint32_t get_offered_count() const { return offered_count; }
+    uint32_t get_stored_count() const { return stored_count; }
+    
+private:
+    struct Entry {
+        char host[TLS_SESSION_MAX_HOST + 1];
+        mbedtls_ssl_session session;
+        bool valid;
+        uint32_t last_used_ms;
+        uint32_t expires_ms;     // End of the ticket lifetime (uptime)
+    };
+    
+    Entry entries[TLS_SESSION_CACHE_SIZE];
+    bool dirty;
+    bool purge_pending;          // An expired session may still be in flash
+    uint32_t last_flash_write_ms;
+    uint32_t offered_count;
+    uint32_t stored_count;
+    
+    Entry* find(const std::string& host);
+    Entry* find_slot(const std::string& host);
+    void clear_entry(Entry& entry);
+    void expire(uint32_t now_ms);
+};
@@ -0,0 +1,115 @@
+#include "wifi_connect_cache.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <cstring>
+#include <cstdio>
+
+// The sector below the TLS sessions, which have the last one
+#define WIFI_CONNECT_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+#define WIFI_CONNECT_FLASH_MAGIC 0x49464957u  // "WIFI"
+#define WIFI_CONNECT_FLASH_VERSION 1
+
+struct ConnectFlashImage {
+    uint32_t magic;
+    uint32_t version;
+    WifiConnectCache::Record record;
+};
+
+// One flash page is the smallest unit that can be programmed
+static uint8_t flash_page[FLASH_PAGE_SIZE];
+
+static_assert(sizeof(ConnectFlashImage) <= FLASH_PAGE_SIZE, "WiFi record must fit one flash page");
+
+WifiConnectCache::WifiConnectCache()
+    : valid(false)
+    , dirty(false) {
+    memset(&record, 0, sizeof(record));
+}
+
+bool WifiConnectCache::load_from_flash() {
+#if WIFI_CONNECT_PERSIST_FLASH
+    ConnectFlashImage image;
+    memcpy(&image, (const void*)(XIP_BASE + WIFI_CONNECT_FLASH_OFFSET), sizeof(image));
+    if (image.magic != WIFI_CONNECT_FLASH_MAGIC || image.version != WIFI_CONNECT_FLASH_VERSION) {
+        return false;  // Blank sector or an older layout
+    }
+    
+    record = image.record;
+    record.ssid[WIFI_CONNECT_MAX_SSID] = '\0';
+    valid = true;
+    
+    printf("WiFi cache: last joined %s on channel %lu\n", record.ssid, (unsigned long)record.channel);
+    return true;
+#else
+    return false;
+#endif
+}
+
+const WifiConnectCache::Record* WifiConnectCache::lookup(const std::string& ssid) const {
+    if (!valid || ssid != record.ssid) {
+        return nullptr;
+    }
+    return &record;
+}
+
+void WifiConnectCache::store(const std::string& ssid, const uint8_t bssid[6], uint32_t channel, uint32_t ip) {
+    if (ssid.length() > WIFI_CONNECT_MAX_SSID) {
+        return;
+    }
+    
+    Record updated;
+    memset(&updated, 0, sizeof(updated));
+    memcpy(updated.ssid, ssid.data(), ssid.length());
+    memcpy(updated.bssid, bssid, sizeof(updated.bssid));
+    updated.channel = channel;
+    updated.ip = ip;
+    
+    // Same access point and address as last time - spare the sector
+    if (memcmp(&updated, &record, sizeof(record)) != 0) {
+        dirty = true;
+    }
+    record = updated;
+    valid = true;
+}
+
+bool WifiConnectCache::flush() {
+    if (!dirty) {
+        return false;
+    }
+    
+    // Tried once per change - a failed write is not worth another stall
+    dirty = false;
+    return save_to_flash();
+}
+
+void WifiConnectCache::forget() {
+    valid = false;
+}
+
+#if WIFI_CONNECT_PERSIST_FLASH
+static void program_connect_sector(void* param) {
+    (void)param;
+    flash_range_erase(WIFI_CONNECT_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(WIFI_CONNECT_FLASH_OFFSET, flash_page, FLASH_PAGE_SIZE);
+}
+#endif
+
+bool WifiConnectCache::save_to_flash() {
+#if WIFI_CONNECT_PERSIST_FLASH
+    ConnectFlashImage image = { WIFI_CONNECT_FLASH_MAGIC, WIFI_CONNECT_FLASH_VERSION, record };
+    memset(flash_page, 0xFF, sizeof(flash_page));
+    memcpy(flash_page, &image, sizeof(image));
+    
+    // Erasing stalls XIP, so the other core (if running) must be parked
+    int rc = flash_safe_execute(program_connect_sector, nullptr, 100);
+    if (rc != PICO_OK) {
+        printf("WiFi cache: flash write failed: %d\n", rc);
+        return false;
+    }
+    
+    printf("WiFi cache: saved %s on channel %lu\n", record.ssid, (unsigned long)record.channel);
+    return true;
+#else
+    return false;
+#endif
+}
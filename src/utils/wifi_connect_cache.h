@@ -0,0 +1,58 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include <string>
+#include <cstdint>
+
+// Keep the last access point and address in flash (0 = RAM only)
+// The record is written by flush(), which the main loop runs on a frame
+// that drew nothing: the sector erase holds off interrupts on this core,
+// the Hub75 refresh included, so the panel still stalls for the ~50 ms of
+// the erase - once per changed access point or address.
+#ifndef WIFI_CONNECT_PERSIST_FLASH
+#define WIFI_CONNECT_PERSIST_FLASH 1
+#endif
+
+// Longest SSID allowed by 802.11
+#define WIFI_CONNECT_MAX_SSID 32
+
+// Last successful WiFi association
+// A join that names the access point and its channel skips the scan over
+// every channel, and asking DHCP for the previous address (INIT-REBOOT) takes
+// one request/ack instead of discover/offer/request/ack. Together they bring
+// a join from several seconds down to about one. Nothing here is trusted: a
+// stale access point fails the join and a stale address gets a NAK, and both
+// fall back to the normal path.
+class WifiConnectCache {
+public:
+    struct Record {
+        char ssid[WIFI_CONNECT_MAX_SSID + 1];
+        uint8_t bssid[6];
+        uint32_t channel;
+        uint32_t ip;                 // Leased IPv4 address, network order (0 = none)
+    };
+    
+    WifiConnectCache();
+    
+    // Restore the record saved before the last reboot
+    bool load_from_flash();
+    
+    // The record for ssid, or nullptr if there is none
+    const Record* lookup(const std::string& ssid) const;
+    
+    // Remember a successful association; a change is left for flush()
+    void store(const std::string& ssid, const uint8_t bssid[6], uint32_t channel, uint32_t ip);
+    
+    // Write a changed record to flash - only while the panel is static
+    bool flush();
+    
+    // Stop offering the record until the next store() - it did not work
+    void forget();
+    
+private:
+    Record record;
+    bool valid;
+    bool dirty;                  // record changed since it was last written
+    
+    bool save_to_flash();
+};